@@ -2,6 +2,10 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#define ITU_LIB_COLLISIONS_IMPLEMENTATION
+#include <itu_common.hpp>
+#include <itu_lib_overlaps.hpp>
+
 #include <array>
 #include <filesystem>
 
@@ -9,19 +13,6 @@
 #define NUM_ASTEROIDS 10
 #define MAX_BULLETS 10
 
-#define VALIDATE(expression) if(!(expression)) { SDL_Log("%s\n", SDL_GetError()); }
-
-#define NANOS(x)   (x)                // converts nanoseconds into nanoseconds
-#define MICROS(x)  (NANOS(x) * 1000)  // converts microseconds into nanoseconds
-#define MILLIS(x)  (MICROS(x) * 1000) // converts milliseconds into nanoseconds
-#define SECONDS(x) (MILLIS(x) * 1000) // converts seconds into nanoseconds
-
-#define NS_TO_MILLIS(x)  ((float)(x)/(float)1000000)    // converts nanoseconds to milliseconds (in floating point precision)
-
-
-
-#define NS_TO_SECONDS(x) ((float)(x)/(float)1000000000) // converts nanoseconds to seconds (in floating point precision)
-
 struct SDLContext {
     SDL_Renderer *renderer{};
 
@@ -312,22 +303,41 @@ static void update(SDLContext *context, GameState *game_state) {
     {
         for (auto &bullet: game_state->bullets) {
             if (bullet.active) {
-                bullet.rect.y -= bullet.speed * context->delta;
+                // NOTE: bullets are fast enough to jump over an asteroid in a single (long) frame, so instead of testing
+                //       only where they end up we sweep them along the whole step (see `itu_lib_sweep_rect_rect()`)
+                vec2f bullet_min = {bullet.rect.x, bullet.rect.y};
+                vec2f bullet_max = {bullet.rect.x + bullet.rect.w, bullet.rect.y + bullet.rect.h};
+                vec2f bullet_displacement = {0, -bullet.speed * context->delta};
+
+                bullet.rect.y += bullet_displacement.y;
                 if (bullet.rect.y + bullet.rect.h < 0) {
                     bullet.active = false;
                 }
 
-                // check collision with asteroids
+                // check collision with asteroids (the first one hit along the way takes the bullet)
+                Entity *asteroid_hit = nullptr;
+                float asteroid_hit_toi = 1;
                 for (auto &asteroid: game_state->asteroids) {
                     if (!asteroid.active || asteroid.spawn_delay > 0) continue;
 
-                    if (SDL_HasRectIntersectionFloat(&bullet.rect, &asteroid.rect)) {
-                        bullet.active = false;
-                        asteroid.active = false;
-                        asteroid.spawn_delay = 3.0f + SDL_randf() * 5.0f;
+                    // asteroids already moved this frame, so go back to where they started
+                    vec2f asteroid_displacement = {0, asteroid.velocity * context->delta};
+                    vec2f asteroid_min = vec2f{asteroid.rect.x, asteroid.rect.y} - asteroid_displacement;
+                    vec2f asteroid_max = asteroid_min + vec2f{asteroid.rect.w, asteroid.rect.h};
+
+                    float toi;
+                    if (itu_lib_sweep_rect_rect(bullet_min, bullet_max, bullet_displacement, asteroid_min, asteroid_max, asteroid_displacement, &toi, nullptr) && toi <= asteroid_hit_toi) {
+                        asteroid_hit = &asteroid;
+                        asteroid_hit_toi = toi;
                     }
                 }
 
+                if (asteroid_hit) {
+                    bullet.active = false;
+                    asteroid_hit->active = false;
+                    asteroid_hit->spawn_delay = 3.0f + SDL_randf() * 5.0f;
+                }
+
                 // draw bullet
                 SDL_SetRenderDrawColor(context->renderer, 255, 255, 0, 255);
                 SDL_RenderFillRect(context->renderer, &bullet.rect);
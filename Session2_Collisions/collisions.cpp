@@ -9,6 +9,10 @@
 #include <itu_common.hpp>
 #include <itu_lib_render.hpp>
 #include <itu_lib_overlaps.hpp>
+#include <itu_lib_bvh.hpp>
+#include <itu_lib_jobs.hpp>
+#include <itu_lib_pairs.hpp>
+#include <itu_lib_arena.hpp>
 
 #define ENABLE_DIAGNOSTICS
 
@@ -27,27 +31,106 @@
 // - world partition, 16 cells (all dynamic)    ~3000       16   ms/f
 // - world partition, 64 cells (all dynamic)    ~4000       16   ms/f
 //
-#define ENTITY_COUNT 1600
+// NOTE: the world partition numbers above were taken with the old per-cell arrays. Press [F5] to run
+//       `world_partition_benchmark()`, which logs build and check timings for 1 to 1024 cells with the current entities
+// NOTE: static entities are not in the broadphases anymore, they live in their own grid built once (see `StaticGrid`)
+// NOTE: the numbers above include rendering. collisions_benchmark.cpp runs the same collision pipeline without a window,
+//       over a sweep of scenarios, and writes median/p99 timings of every phase to a CSV file
+//
+// NOTE: the benchmark needs more room, so these can be defined before including this file
+#ifndef ENTITY_DYNAMIC_COUNT
+#define ENTITY_DYNAMIC_COUNT 1600
+#endif
+#ifndef ENTITY_STATIC_COUNT
+#define ENTITY_STATIC_COUNT  1024
+#endif
+#define ENTITY_COUNT (ENTITY_DYNAMIC_COUNT + ENTITY_STATIC_COUNT)
+
+// contacts are stored in blocks of this many, allocated from the frame arena (see `ContactStream`)
+#define CONTACT_BLOCK_SIZE 256
 
-#define MAX_COLLISIONS (ENTITY_COUNT * 6)   // num max collisions per frame
+// the frame arena asks for memory in chunks this big. The high-water mark is in the diagnostics,
+// if it's often above this, make it bigger
+#define FRAME_ARENA_CHUNK_SIZE KB(256)
 
+// default number of splits per axis (can be changed at runtime with [F6]/[F7], 0 disables the world partition)
 #define WORLD_PARTITION_CELL_SPLITS 8
+#define WORLD_PARTITION_CELL_SPLITS_MAX 256
+
+// collision layers (bit flags). Two colliders interact only if the layer of each one is in the mask of the other
+#define COLLISION_LAYER_DEFAULT (1u << 0)
+#define COLLISION_LAYER_WALL    (1u << 1)
+#define COLLISION_LAYER_GHOST   (1u << 2) // only hits walls, passes through everything else
+#define COLLISION_MASK_ALL      SDL_MAX_UINT32
+
+// dynamic entities are grouped by the highest bit of their layer, so there can't be more groups than bits (see `CollisionLayerBuckets`)
+#define COLLISION_LAYER_BUCKETS_MAX 32
+
+// number of splits per axis of the static colliders grid
+#define STATIC_GRID_SPLITS 64
+
+// how much the BVH leaves get enlarged, entities moving less than this don't need to touch the tree
+#define BVH_MARGIN 4.0f
 
-// NOTE: this is actually an interesting design choice: how many entities can exist in a single cell *at the same time*
-//       In the worst case, all entities are in the same cell, and as unlikely as that this can we affort to do less?
-//       Maybe, but finding a reasonable number that you can enforce efficiently is not trivial, and this is why this "fixed split"
-//       method is never used in real-world application, and more refined algorithms exist.
-#define WORLD_PARTITION_CELL_MAX_ENTITY_COUNT   (ENTITY_COUNT)
+// an entity moving less than this (in pixels) during a frame counts as still, an island that stays still
+// for `SLEEP_FRAMES` frames in a row goes to sleep (see `sleep_update()`)
+#define SLEEP_DISTANCE 0.05f
+#define SLEEP_FRAMES   30
+
+// contacts are split in colors, so that no two contacts of the same color move the same entity, and each color is separated
+// in parallel in jobs of `SEPARATION_JOB_SIZE` contacts (see `collision_separate()`).
+// Contacts that don't fit in any color are separated on a single thread, after all the others
+#define SEPARATION_COLORS_MAX 64 // one bit per color in a Uint64
+#define SEPARATION_ITERATIONS 4  // default, can be changed at runtime with [F12]
+#define SEPARATION_JOB_SIZE   256
+
+// world partition cells are checked in parallel, split in (at most) this many jobs.
+// The split only depends on the number of cells, so the merged collisions are the same with any number of threads
+#define COLLISION_JOBS_MAX 64
+
+// NOTE: how many entities can exist in a single cell *at the same time* used to be an interesting design choice:
+//       with a fixed array per cell, the worst case (all entities in the same cell) forces us to allocate cells * entities references.
+//       Instead, we now rebuild the whole partition every frame with a counting sort (see `world_partition_build()`),
+//       so all cells share a single array and memory only grows with the number of entity<>cell overlaps
 
 
 bool DEBUG_separate_collisions   = true;
 bool DEBUG_render_colliders      = true;
 bool DEBUG_render_texture_border = false;
 bool DEBUG_render_texture        = false;
+bool DEBUG_sleeping              = true;
 
 struct Entity;
 struct EntityCollisionInfo;
+struct WorldPartitionRange;
 struct WorldPartitionCell;
+struct WorldPartitionMembership;
+struct SweepAndPruneEndpoint;
+struct StaticGrid;
+struct CollisionJob;
+struct CollisionPair;
+struct ContactBlock;
+struct SeparationConstraint;
+
+// collisions found during the frame, in blocks allocated from `GameState::frame_arena`.
+// There is no upper limit, the stream just grabs more blocks, and everything goes away in O(1) when the arena is reset
+struct ContactStream
+{
+	ContactBlock* first;
+	ContactBlock* last;
+	int           count;
+};
+
+enum BroadphaseType
+{
+	BROADPHASE_TYPE_WORLD_PARTITION,
+	BROADPHASE_TYPE_SWEEP_AND_PRUNE,
+	BROADPHASE_TYPE_BVH,
+
+	BROADPHASE_TYPE_MAX
+};
+
+const char* BROADPHASE_TYPE_NAMES[BROADPHASE_TYPE_MAX] = { "grid", " SAP", " BVH" };
 
 struct SDLContext
 {
@@ -68,6 +151,95 @@ struct SDLContext
 	vec2f mouse_pos;
 };
 
+// dynamic entities grouped by collision layer, so that the broadphases can skip whole groups that can never collide
+// instead of rejecting them one pair at a time (see `collision_layer_buckets_update()`)
+// NOTE: a bucket is every entity sharing the highest bit of its layer. Entities of the same bucket can still have
+//       different layers and masks, so the per pair test is still needed, buckets only throw away what can't ever match
+struct CollisionLayerBuckets
+{
+	int    count;
+	Uint8  bit_buckets[32];                         // bucket of the entities whose highest layer bit is `i` (layer 0 goes with bit 0)
+	Uint32 layers[COLLISION_LAYER_BUCKETS_MAX];     // OR of the layers of the members
+	Uint32 masks[COLLISION_LAYER_BUCKETS_MAX];      // OR of the masks of the members
+	Uint32 compatible[COLLISION_LAYER_BUCKETS_MAX]; // bit `j` of `compatible[i]` is set if members of buckets `i` and `j` can collide
+	int    members_count[COLLISION_LAYER_BUCKETS_MAX];
+};
+
+// uniform grid, with two ways of keeping it up to date:
+// - rebuilt every frame with a counting sort (see `world_partition_build()`)
+//   bin `i` references the entities `entity_idxs[cell_start[i]]` to `entity_idxs[cell_start[i+1] - 1]`
+// - incremental, only entities that cross a cell boundary get moved (see `world_partition_update_incremental()`)
+//   bin `i` references the entities in `cells[i]`
+// every cell is split in one bin per layer bucket (see `world_partition_get_bin_idx()`), so that the narrowphase
+// can skip the buckets of a cell that can't collide with each other
+// use `world_partition_get_bin()` to read a bin without caring about the mode
+struct WorldPartition
+{
+	int   splits;        // number of cells per axis (0 means disabled)
+	int   cells_count;
+	vec2f cell_size;
+	int   buckets_count; // layer buckets the bins were allocated for
+	int   bins_count;    // `cells_count * buckets_count`
+
+	int* cell_start;   // `bins_count + 1` entries, the last one is the total number of references
+	int* cell_cursor;  // scratch memory used while scattering entities into their bins
+
+	// NOTE: these are 32-bit indices into `GameState::entities`, not pointers (half the memory, and they survive a realloc of the entities)
+	Uint32* entity_idxs;
+	int     entity_idxs_capacity;
+
+	WorldPartitionRange* entity_ranges; // cells covered by each entity, one entry per entity
+
+	// incremental mode
+	bool                      incremental;
+	WorldPartitionCell*       cells;                // one per bin
+	WorldPartitionMembership* memberships;          // pool of entity<>cell links
+	int                       memberships_capacity;
+	Uint32                    memberships_free;     // head of the free list inside `memberships`
+	Uint32*                   entity_memberships;   // first link of each entity, one entry per entity
+	int                       movers_count;         // entities that changed cells during the last update
+};
+
+// sweep and prune on the x axis (see `sweep_and_prune_update()`)
+struct SweepAndPrune
+{
+	SweepAndPruneEndpoint* endpoints;   // two per entity (min and max of the collider on the x axis), kept sorted between frames
+	int                    endpoints_count;
+
+	// scratch memory used during the sweep
+	// NOTE: one active list per layer bucket, so an opening interval only looks at the lists it can collide with.
+	//       The lists share `active`, each bucket gets as many entries as it has members (see `sweep_and_prune_reset()`)
+	Uint32* active;       // entities whose interval is currently open
+	int     active_start[COLLISION_LAYER_BUCKETS_MAX];
+	int     active_count[COLLISION_LAYER_BUCKETS_MAX];
+	Uint32* active_slots; // position of each entity inside its bucket's active list, one entry per entity
+
+	int swaps_count;      // insertion sort swaps during the last update
+};
+
+// static colliders never move, so they get their own grid, built once in `game_reset()` (see `static_grid_build()`)
+// and then only queried by dynamic entities. Same counting sort layout as `WorldPartition`, with two differences:
+// - each static is stored only in the cell containing its center, and queries grow their range by `radius_max` instead,
+//   so a dynamic entity finds every static at most once
+// - colliders are copied in cell order, in SoA layout, so consecutive cells of a row are a single batch for `itu_lib_overlaps_circle_circles()`
+struct StaticGrid
+{
+	int   splits;
+	vec2f cell_size;
+	float  radius_max; // biggest static collider
+	Uint32 layers;     // OR of the layers of all statics
+	Uint32 masks;      // OR of the masks of all statics
+
+	int*    cell_start;  // `splits * splits + 1` entries, the last one is the number of statics
+	int*    cell_cursor; // scratch memory used while scattering statics into their cells
+	Uint32* entity_idxs;
+	float*  x;
+	float*  y;
+	float*  radius;
+	int*    hits;        // scratch memory for the batch tests
+	int     count;
+};
+
 struct GameState
 {
 	Entity* player;
@@ -78,17 +250,44 @@ struct GameState
 
 
 	// collision system data
-	EntityCollisionInfo* frame_collisions;
-	int frame_collisions_count;
-
-	WorldPartitionCell* world_partition_cells;
-	int                 world_partition_cells_count;
-	vec2f               world_partition_cell_size;
+	Arena         frame_arena;      // reset at the beginning of every `collision_check()`
+	ContactStream frame_collisions;
+
+	// colliding pairs that survive across frames (`CollisionPair` user data), see `collision_update_pairs()`
+	PairTable collision_pairs;
+
+	JobPool      jobs;
+	CollisionJob* collision_jobs;       // `COLLISION_JOBS_MAX` entries
+	int           collision_jobs_count; // jobs used by the last `collision_check()`
+
+	// contact graph coloring (see `collision_separate()`)
+	Uint64* separation_entity_colors; // colors already used by the contacts of each entity, one entry per entity (all zeroes between frames)
+	int     separation_iterations;
+	int     separation_colors_count;  // colors used during the last separation
+	int     separation_overflow_count; // contacts that didn't fit in any color
+
+	// islands of touching entities, scratch memory rebuilt by every `sleep_update()` (one entry per entity)
+	Uint32* island_parents;   // union-find
+	Uint32* island_heads;     // first member of each island going to sleep
+	bool*   island_can_sleep; // false if any member of the island moved recently
+	int     islands_count;    // awake islands during the last update
+	int     sleeping_count;
+	int     dozing_count;     // entities that fell asleep since the last `broadphase_update()`
+
+	BroadphaseType        broadphase;
+	CollisionLayerBuckets layer_buckets; // refreshed by `broadphase_reset()`
+	WorldPartition        world_partition;
+	SweepAndPrune         sweep_and_prune;
+	BVH                   bvh;
+	StaticGrid            static_grid;
+	int*                  bvh_leaves;          // leaf of each entity, one entry per entity
+	int                   bvh_reinserts_count; // leaves that left their fat AABB during the last update
 
 	// SDL-allocated structures
 	SDL_Texture* atlas;
 };
 
+#ifndef COLLISIONS_HEADLESS
 static SDL_Texture* texture_create(SDLContext* context, const char* path)
 {
 	int w=0, h=0, n=0;
@@ -102,6 +301,7 @@ static SDL_Texture* texture_create(SDLContext* context, const char* path)
 
 	return ret;
 }
+#endif
 
 // ********************************************************************************************************************
 // sprite
@@ -115,6 +315,7 @@ struct Sprite
 	vec2f        pivot;
 };
 
+#ifndef COLLISIONS_HEADLESS
 // quick sprite rendering function that takes care of most of the functionalities
 // NOTE: this function is still temporary since ATM we can't really deal with game worlds bigger than the rendering window
 //       we will address it in lecture 03, and then we will just create a final sprite system and be done with it
@@ -139,6 +340,7 @@ static void sprite_render(SDLContext* context, vec2f position, vec2f size, Sprit
 		SDL_RenderRect(context->renderer, &dst_rect);
 	}
 }
+#endif
 
 // ********************************************************************************************************************
 // entity
@@ -152,9 +354,21 @@ struct Entity
 	Sprite sprite;
 
 	// collider info
-	bool  collider_is_static;
-	float collider_radius;
-	vec2f collider_offset;
+	bool   collider_is_static;
+	float  collider_radius;
+	vec2f  collider_offset;
+	Uint32 collider_layer; // see `COLLISION_LAYER_*`
+	Uint32 collider_mask;
+
+	int contacts_count; // colliding pairs this entity is part of, kept up to date by begin/end events
+
+	// sleeping (see `sleep_update()`)
+	bool   is_sleeping;
+	bool   is_waking;      // woken up during this frame, after the narrowphase skipped its pairs (see `collision_pair_keep()`)
+	bool   is_dozing;      // fell asleep after the last broadphase update, which hasn't seen where it stopped yet (see `entity_is_still()`)
+	int    sleep_frames;   // consecutive frames spent (almost) still
+	vec2f  sleep_position; // position at the end of the last update, to tell how much it moved since then
+	Uint32 island_next;    // next member of the same sleeping island (circular list), only meaningful while sleeping
 };
 
 static Entity* entity_create(GameState* state)
@@ -181,290 +395,1732 @@ static void entity_destroy(GameState* state, Entity* entity)
 	*entity = state->entities[state->entities_alive_count];
 }
 
+// sleeping entities don't move, so the broadphases can leave them where they are.
+// Except for the first update after falling asleep: they still moved during the separation of that frame
+static inline bool entity_is_still(Entity* entity)
+{
+	return entity->is_sleeping && !entity->is_dozing;
+}
+
+// ********************************************************************************************************************
+// collision layer buckets
+// ********************************************************************************************************************
+
+static inline int collision_layer_bucket(CollisionLayerBuckets* buckets, Entity* entity)
+{
+	Uint32 layer = entity->collider_layer;
+	return buckets->bit_buckets[layer ? SDL_MostSignificantBitIndex32(layer) : 0];
+}
+
+// regroups the dynamic entities by layer and works out which groups can collide with each other
+// NOTE: buckets are only refreshed by `broadphase_reset()`, so that has to be called after changing layers or masks
+static void collision_layer_buckets_update(GameState* state)
+{
+	CollisionLayerBuckets* buckets = &state->layer_buckets;
+	SDL_memset(buckets, 0, sizeof(CollisionLayerBuckets));
+
+	// one bucket per highest layer bit in use, in bit order
+	Uint32 bits_used = 0;
+	for(int i = 0; i < state->entities_alive_count; ++i)
+	{
+		Uint32 layer = state->entities[i].collider_layer;
+		if(!state->entities[i].collider_is_static)
+			bits_used |= 1u << (layer ? SDL_MostSignificantBitIndex32(layer) : 0);
+	}
+	for(int bit = 0; bit < 32; ++bit)
+		if(bits_used & (1u << bit))
+			buckets->bit_buckets[bit] = (Uint8)buckets->count++;
+
+	// an empty world still gets a bucket, so the broadphases never have to deal with zero of them
+	buckets->count = SDL_max(buckets->count, 1);
 
+	for(int i = 0; i < state->entities_alive_count; ++i)
+	{
+		Entity* entity = &state->entities[i];
+		if(entity->collider_is_static)
+			continue;
+
+		int bucket = collision_layer_bucket(buckets, entity);
+		buckets->layers[bucket] |= entity->collider_layer;
+		buckets->masks[bucket]  |= entity->collider_mask;
+		buckets->members_count[bucket]++;
+	}
+
+	// same test as `collision_layers_match()`, on the whole bucket
+	for(int i = 0; i < buckets->count; ++i)
+		for(int j = 0; j < buckets->count; ++j)
+			if((buckets->layers[i] & buckets->masks[j]) && (buckets->layers[j] & buckets->masks[i]))
+				buckets->compatible[i] |= 1u << j;
+}
 
 // ********************************************************************************************************************
 // world partition
 // ********************************************************************************************************************
 
+#define WORLD_PARTITION_INVALID_IDX SDL_MAX_UINT32
+
+// range of cells covered by an entity's collider (inclusive on both ends)
+struct WorldPartitionRange
+{
+	Uint16 min_x;
+	Uint16 min_y;
+	Uint16 max_x;
+	Uint16 max_y;
+};
+
 struct WorldPartitionCell
 {
-	// NOTE: this is an array of pointers
-	Entity** entity_refs;
-	int      entity_refs_counts;
+	Uint32* entity_idxs;     // same layout as the span used by the counting sort version
+	Uint32* membership_idxs; // back-reference to the link that owns each slot
+	int     count;
+	int     capacity;
+};
 
-	vec2f min;
-	vec2f max;
+struct WorldPartitionMembership
+{
+	Uint32 bin_idx;
+	Uint32 slot;  // position inside `cells[bin_idx]`
+	Uint32 next;  // next link of the same entity (or next free link, when in the free list)
 };
 
-// fancy debug visualization for an incredibly simple world partition
-// the code is a mess tho, we will try to make it better when we talk about UIs
-static void world_partition_debug_cells(SDLContext* context, GameState* state)
+// the buckets of a cell are next to each other, so the counting sort leaves each cell contiguous and sorted by bucket
+static inline int world_partition_get_bin_idx(WorldPartition* partition, int cell_idx, int bucket)
 {
-	// render cell boundaries
-	SDL_SetRenderDrawColor(context->renderer, 0xFF, 0xFF, 0xFF, 0xFF);
-	for(int i = 0; i < state->world_partition_cells_count; ++i)
-	{
-		WorldPartitionCell* cell = &state->world_partition_cells[i];
-		SDL_FRect rect = { cell->min.x, cell->min.y, state->world_partition_cell_size.x, state->world_partition_cell_size.y };
-		SDL_RenderRect(context->renderer, &rect);
+	return cell_idx * partition->buckets_count + bucket;
+}
 
+// (re)allocates the per-bin data, for the current number of cells and the given number of layer buckets
+static void world_partition_set_bins(WorldPartition* partition, int buckets_count)
+{
+	// incremental cells own their arrays, release them before resizing
+	for(int i = 0; i < partition->bins_count; ++i)
+	{
+		SDL_free(partition->cells[i].entity_idxs);
+		SDL_free(partition->cells[i].membership_idxs);
 	}
 
-	// render cell debug info
-	SDL_SetRenderDrawColor(context->renderer, 0x0, 0x00, 0x00, 0xCC);
-	SDL_FRect rect = SDL_FRect{ 250, 5, 230 + 225, state->world_partition_cells_count * 10.0f + 35.0f };
-	SDL_RenderFillRect(context->renderer, &rect);
+	partition->buckets_count = buckets_count;
+	partition->bins_count = partition->cells_count * buckets_count;
 
-	SDL_SetRenderDrawColor(context->renderer, 0xFF, 0xFF, 0xFF, 0xFF);
-	SDL_RenderDebugText(context->renderer, 255, 10, "cell   entities   rect min          rect max");
-	SDL_RenderLine(context->renderer, 255, 20, 250+230 + 220, 20);
+	if(partition->bins_count == 0)
+		return;
 
-	float base_text_render_y = 40;
-	int entity_refs_total = 0;
-	for(int i = 0; i < state->world_partition_cells_count; ++i)
+	partition->cell_start  = (int*)SDL_realloc(partition->cell_start,  (partition->bins_count + 1) * sizeof(int));
+	partition->cell_cursor = (int*)SDL_realloc(partition->cell_cursor, (partition->bins_count + 1) * sizeof(int));
+	SDL_assert(partition->cell_start && partition->cell_cursor);
+	SDL_memset(partition->cell_start, 0, (partition->bins_count + 1) * sizeof(int));
+
+	partition->cells = (WorldPartitionCell*)SDL_realloc(partition->cells, partition->bins_count * sizeof(WorldPartitionCell));
+	SDL_assert(partition->cells);
+	SDL_memset(partition->cells, 0, partition->bins_count * sizeof(WorldPartitionCell));
+}
+
+// (re)allocates the per-cell data for the given number of splits
+// NOTE: cells are just two integers now, so we can afford to change this at runtime
+static void world_partition_set_splits(WorldPartition* partition, int splits)
+{
+	partition->splits = SDL_clamp(splits, 0, WORLD_PARTITION_CELL_SPLITS_MAX);
+
+	if(partition->splits > 0)
 	{
-		WorldPartitionCell* cell = &state->world_partition_cells[i];
-		entity_refs_total += cell->entity_refs_counts;
-		SDL_RenderDebugTextFormat(
-			context->renderer, 255, base_text_render_y + 10 * i,
-			"%4d   %4d       (%6.1f, %6.1f)   (%6.1f,  %6.1f)",
-			i, cell->entity_refs_counts, cell->min.x, cell->min.y, cell->max.x, cell->max.y
-		);
+		partition->cell_size.x = WINDOW_W / (float)partition->splits;
+		partition->cell_size.y = WINDOW_H / (float)partition->splits;
 	}
-	SDL_RenderDebugTextFormat(
-		context->renderer, 255, base_text_render_y -15,
-		" tot   %4d",
-		entity_refs_total
-	);
-	SDL_RenderLine(context->renderer, 255, base_text_render_y-5, 250+230 + 220, base_text_render_y + -5);
+
+	// the bins from the old number of cells are released before `cells_count` changes
+	int buckets_count = SDL_max(partition->buckets_count, 1);
+	world_partition_set_bins(partition, 0);
+	partition->cells_count = partition->splits * partition->splits;
+	world_partition_set_bins(partition, buckets_count);
 }
 
-static void world_partition_cell_add_entity(Entity* entity, WorldPartitionCell* cell)
+static WorldPartitionRange world_partition_get_range(WorldPartition* partition, Entity* entity)
 {
-	SDL_assert(cell->entity_refs_counts < WORLD_PARTITION_CELL_MAX_ENTITY_COUNT);
-	cell->entity_refs[cell->entity_refs_counts] = entity;
-	cell->entity_refs_counts++;
+	vec2f p = entity->position + entity->collider_offset;
+	float r = entity->collider_radius;
+	int   max_coord = partition->splits - 1;
+
+	// get cell coordinates from the collider's bounding box
+	// NOTE: everything outside of the window gets clamped to the border cells
+	WorldPartitionRange ret;
+	ret.min_x = (Uint16)SDL_clamp((int)((p.x - r) / partition->cell_size.x), 0, max_coord);
+	ret.min_y = (Uint16)SDL_clamp((int)((p.y - r) / partition->cell_size.y), 0, max_coord);
+	ret.max_x = (Uint16)SDL_clamp((int)((p.x + r) / partition->cell_size.x), 0, max_coord);
+	ret.max_y = (Uint16)SDL_clamp((int)((p.y + r) / partition->cell_size.y), 0, max_coord);
+	return ret;
 }
 
-// (overly) simple world partition logic, just split the world in 4 quadrant
-static void world_partition_assign_entity_to_cell(Entity* entity, GameState* state)
+// rebuilds the whole world partition with a counting sort:
+// 1. count how many entities overlap each bin (cell and layer bucket)
+// 2. prefix sum the counts, so that each bin knows where its span starts
+// 3. scatter the entity indices into their bins' spans
+// every pass is linear in the number of entities (or bins), and the result is a single contiguous array
+// NOTE: sleeping entities are rebuilt like everybody else, the incremental mode is the one that can skip them
+static void world_partition_build(GameState* state)
 {
-	vec2f p = entity->position + entity->collider_offset;
+	WorldPartition* partition = &state->world_partition;
+	int* cell_start = partition->cell_start;
 
-	// get cell coordinates form collider center
-	int coord_x = SDL_clamp((int) p.x / state->world_partition_cell_size.x, 0, WORLD_PARTITION_CELL_SPLITS - 1);
-	int coord_y = SDL_clamp((int) p.y / state->world_partition_cell_size.y, 0, WORLD_PARTITION_CELL_SPLITS - 1);
+	// 1. count
+	SDL_memset(cell_start, 0, (partition->bins_count + 1) * sizeof(int));
+	for(int i = 0; i < state->entities_alive_count; ++i)
+	{
+		if(state->entities[i].collider_is_static)
+			continue;
 
-	// get cell index from coordinates
-	int idx_center = coord_x + coord_y * WORLD_PARTITION_CELL_SPLITS;
-	SDL_assert(idx_center < state->world_partition_cells_count);
-	world_partition_cell_add_entity(entity, &state->world_partition_cells[idx_center]);
+		WorldPartitionRange range = world_partition_get_range(partition, &state->entities[i]);
+		partition->entity_ranges[i] = range;
 
-	vec2f bounds[] = { p, p, p, p };
-	bounds[0].x += entity->collider_radius;
-	bounds[1].y -= entity->collider_radius;
-	bounds[2].x -= entity->collider_radius;
-	bounds[3].y += entity->collider_radius;
+		int bucket = collision_layer_bucket(&state->layer_buckets, &state->entities[i]);
+		for(int y = range.min_y; y <= range.max_y; ++y)
+			for(int x = range.min_x; x <= range.max_x; ++x)
+				cell_start[world_partition_get_bin_idx(partition, x + y * partition->splits, bucket)]++;
+	}
 
-	for(int i = 0; i < 4; ++i)
+	// 2. prefix sum (exclusive, so `cell_start[i]` is the first slot of bin `i`)
+	int total = 0;
+	for(int i = 0; i < partition->bins_count; ++i)
 	{
-		vec2f p = bounds[i];
-		// get cell coordinates form entity extremes
-		int coord_x = SDL_clamp((int) p.x / state->world_partition_cell_size.x, 0, WORLD_PARTITION_CELL_SPLITS - 1);
-		int coord_y = SDL_clamp((int) p.y / state->world_partition_cell_size.y, 0, WORLD_PARTITION_CELL_SPLITS - 1);
-
-		// get cell index from coordinates
-		int idx_bound = coord_x + coord_y * WORLD_PARTITION_CELL_SPLITS;
-		SDL_assert(idx_center < state->world_partition_cells_count);
-		if(idx_bound != idx_center)
-			world_partition_cell_add_entity(entity, &state->world_partition_cells[idx_bound]);
+		int count = cell_start[i];
+		cell_start[i] = total;
+		partition->cell_cursor[i] = total;
+		total += count;
 	}
-}
+	cell_start[partition->bins_count] = total;
 
-static void world_partition_assign_all_entitites(GameState* state)
-{
-	for(int i = 0; i < state->world_partition_cells_count; ++i)
-		state->world_partition_cells[i].entity_refs_counts = 0;
+	// we know exactly how many references we need before writing any of them, so we can grow here (and only here)
+	if(total > partition->entity_idxs_capacity)
+	{
+		partition->entity_idxs_capacity = total + total / 2;
+		partition->entity_idxs = (Uint32*)SDL_realloc(partition->entity_idxs, partition->entity_idxs_capacity * sizeof(Uint32));
+		SDL_assert(partition->entity_idxs);
+	}
 
+	// 3. scatter
 	for(int i = 0; i < state->entities_alive_count; ++i)
 	{
-		Entity* entity = &state->entities[i];
-		world_partition_assign_entity_to_cell(entity, state);
+		if(state->entities[i].collider_is_static)
+			continue;
+
+		WorldPartitionRange range = partition->entity_ranges[i];
+		int bucket = collision_layer_bucket(&state->layer_buckets, &state->entities[i]);
+		for(int y = range.min_y; y <= range.max_y; ++y)
+			for(int x = range.min_x; x <= range.max_x; ++x)
+				partition->entity_idxs[partition->cell_cursor[world_partition_get_bin_idx(partition, x + y * partition->splits, bucket)]++] = (Uint32)i;
 	}
 }
 
-// ********************************************************************************************************************
-// collisions
-// ********************************************************************************************************************
+// ----------------------------------------------------------------------------
+// incremental mode
+//
+// every entity keeps the range of cells it covers (`entity_ranges`) as a key. When the key doesn't change (most
+// entities move less than a cell per frame) there is nothing to do. Otherwise we only touch the cells that
+// the entity left or entered.
+// To remove an entity from a cell in O(1) we need to know where it is stored, so every entity<>cell link
+// (`WorldPartitionMembership`) remembers the slot it occupies in the cell, and every cell slot remembers its link.
+// Removing is a swap with the last slot of the cell, followed by fixing the link of the entity we just swapped.
+// NOTE: this is exactly the two-way reference we couldn't do with pointers, indices make it trivial
+// ----------------------------------------------------------------------------
+
+static inline bool world_partition_range_contains(WorldPartitionRange range, int x, int y)
+{
+	return x >= range.min_x && x <= range.max_x && y >= range.min_y && y <= range.max_y;
+}
 
-struct EntityCollisionInfo
+static inline bool world_partition_range_equals(WorldPartitionRange a, WorldPartitionRange b)
 {
-	Entity* e1;
-	Entity* e2;
+	return a.min_x == b.min_x && a.min_y == b.min_y && a.max_x == b.max_x && a.max_y == b.max_y;
+}
 
-	vec2f normal;
-	float separation;
-};
+// two entities spanning more than one cell can share several of them, but the pair must be tested only once.
+// The owner is the first cell they share (the min corner of the intersection of their ranges), every other cell skips it
+// NOTE: no shared state, so cells checked in parallel agree without talking to each other
+static inline bool world_partition_cell_owns_pair(WorldPartitionRange a, WorldPartitionRange b, int x, int y)
+{
+	return x == SDL_max(a.min_x, b.min_x) && y == SDL_max(a.min_y, b.min_y);
+}
 
-static void collision_check_references(GameState* state, Entity** entity_refs, int entity_refs_count)
+static Uint32 world_partition_membership_alloc(WorldPartition* partition)
 {
-	for(int i = 0; i < entity_refs_count - 1; ++i)
+	if(partition->memberships_free == WORLD_PARTITION_INVALID_IDX)
 	{
-		Entity* e1 = entity_refs[i];
+		// free list is empty, grow the pool and chain all new links in the free list
+		int capacity_old = partition->memberships_capacity;
+		int capacity_new = SDL_max(capacity_old * 2, ENTITY_COUNT * 4);
+		partition->memberships = (WorldPartitionMembership*)SDL_realloc(partition->memberships, capacity_new * sizeof(WorldPartitionMembership));
+		SDL_assert(partition->memberships);
+
+		for(int i = capacity_old; i < capacity_new - 1; ++i)
+			partition->memberships[i].next = i + 1;
+		partition->memberships[capacity_new - 1].next = WORLD_PARTITION_INVALID_IDX;
+		partition->memberships_free = capacity_old;
+		partition->memberships_capacity = capacity_new;
+	}
 
-		if(e1->collider_is_static)
-			continue;
+	Uint32 ret = partition->memberships_free;
+	partition->memberships_free = partition->memberships[ret].next;
+	return ret;
+}
 
-		for(int j = i + 1; j < entity_refs_count; ++j)
-		{
-			Entity* e2 = entity_refs[j];
+static void world_partition_cell_add(WorldPartition* partition, Uint32 entity_idx, int bin_idx)
+{
+	WorldPartitionCell* cell = &partition->cells[bin_idx];
+	if(cell->count == cell->capacity)
+	{
+		cell->capacity = SDL_max(cell->capacity * 2, 16);
+		cell->entity_idxs     = (Uint32*)SDL_realloc(cell->entity_idxs,     cell->capacity * sizeof(Uint32));
+		cell->membership_idxs = (Uint32*)SDL_realloc(cell->membership_idxs, cell->capacity * sizeof(Uint32));
+		SDL_assert(cell->entity_idxs && cell->membership_idxs);
+	}
 
-			if(itu_lib_overlaps_circle_circle(
-				e1->position + e1->collider_offset, e1->collider_radius,
-				e2->position + e2->collider_offset, e2->collider_radius
-			))
-			{
-				// // epilepsy warning right there
-				// e1->sprite.tint = COLOR_RED;
-				// e2->sprite.tint = COLOR_RED;
+	Uint32 membership_idx = world_partition_membership_alloc(partition);
+	WorldPartitionMembership* membership = &partition->memberships[membership_idx];
+	membership->bin_idx  = bin_idx;
+	membership->slot     = cell->count;
+	membership->next     = partition->entity_memberships[entity_idx];
+	partition->entity_memberships[entity_idx] = membership_idx;
 
-				if(state->frame_collisions_count >= MAX_COLLISIONS)
-				{
-					SDL_Log("[WARNING] too many collisions!");
-					return;
-				}
+	cell->entity_idxs[cell->count]     = entity_idx;
+	cell->membership_idxs[cell->count] = membership_idx;
+	cell->count++;
+}
+
+// removes the link from its cell, but doesn't touch the entity's chain (the caller is walking it)
+static void world_partition_cell_remove(WorldPartition* partition, Uint32 membership_idx)
+{
+	WorldPartitionMembership* membership = &partition->memberships[membership_idx];
+	WorldPartitionCell* cell = &partition->cells[membership->bin_idx];
+
+	// swap with last
+	int slot_last = cell->count - 1;
+	cell->entity_idxs[membership->slot]     = cell->entity_idxs[slot_last];
+	cell->membership_idxs[membership->slot] = cell->membership_idxs[slot_last];
+	partition->memberships[cell->membership_idxs[membership->slot]].slot = membership->slot;
+	cell->count--;
+
+	membership->next = partition->memberships_free;
+	partition->memberships_free = membership_idx;
+}
 
-				// NOTE: here we are redoing a bunch of work that we already done in the overlap test. An easy optimization is do to have the test return the collision info
-				vec2f v = (e2->position + e2->collider_offset) - (e1->position + e1->collider_offset);
-				float l = length(v);
-				float separation_vector = e1->collider_radius + e2->collider_radius - l;
-				int new_collision_idx = state->frame_collisions_count++;
+// moves a single entity from its old range of cells to the new one
+// NOTE: the bucket of an entity never changes between resets, only its cells do
+static void world_partition_move_entity(WorldPartition* partition, Uint32 entity_idx, int bucket, WorldPartitionRange range_new)
+{
+	WorldPartitionRange range_old = partition->entity_ranges[entity_idx];
 
-				state->frame_collisions[new_collision_idx].e1 = e1;
-				state->frame_collisions[new_collision_idx].e2 = e2;
-				state->frame_collisions[new_collision_idx].normal = v / l; // normalize vector (we already need the length, so we don't need to call normalize which would do that anyway)
-				state->frame_collisions[new_collision_idx].separation = separation_vector;
-			}
+	// remove the links to the cells we left
+	Uint32* link = &partition->entity_memberships[entity_idx];
+	while(*link != WORLD_PARTITION_INVALID_IDX)
+	{
+		Uint32 membership_idx = *link;
+		WorldPartitionMembership* membership = &partition->memberships[membership_idx];
+		int cell_idx = membership->bin_idx / partition->buckets_count;
+		int cell_x   = cell_idx % partition->splits;
+		int cell_y   = cell_idx / partition->splits;
+		if(world_partition_range_contains(range_new, cell_x, cell_y))
+		{
+			link = &membership->next;
+			continue;
 		}
+
+		*link = membership->next;
+		world_partition_cell_remove(partition, membership_idx);
 	}
+
+	// add links to the cells we entered
+	for(int y = range_new.min_y; y <= range_new.max_y; ++y)
+		for(int x = range_new.min_x; x <= range_new.max_x; ++x)
+			if(!world_partition_range_contains(range_old, x, y))
+				world_partition_cell_add(partition, entity_idx, world_partition_get_bin_idx(partition, x + y * partition->splits, bucket));
+
+	partition->entity_ranges[entity_idx] = range_new;
 }
-static void collision_check(GameState* state)
+
+// NOTE: sleeping entities don't move, so they can be skipped (except when the cells need to be filled from scratch)
+static void world_partition_update_incremental(GameState* state, bool skip_sleeping)
 {
-	state->frame_collisions_count = 0;
+	WorldPartition* partition = &state->world_partition;
+	partition->movers_count = 0;
 
-	if(state->world_partition_cells_count > 0)
+	for(int i = 0; i < state->entities_alive_count; ++i)
 	{
-		// world partition
+		if(state->entities[i].collider_is_static || (skip_sleeping && entity_is_still(&state->entities[i])))
+			continue;
 
-		for(int i = 0; i < state->world_partition_cells_count; ++i)
-		{
-			WorldPartitionCell* cell = &state->world_partition_cells[i];
+		WorldPartitionRange range = world_partition_get_range(partition, &state->entities[i]);
+		if(world_partition_range_equals(range, partition->entity_ranges[i]))
+			continue;
 
-			collision_check_references(state, cell->entity_refs, cell->entity_refs_counts);
-		}
+		world_partition_move_entity(partition, i, collision_layer_bucket(&state->layer_buckets, &state->entities[i]), range);
+		partition->movers_count++;
 	}
-	else {
-		for(int i = 0; i < state->entities_alive_count - 1; ++i)
-		{
-			Entity* e1 = &state->entities[i];
-			if(e1->collider_is_static)
-				continue;
+}
 
-			for(int j = i + 1; j < state->entities_alive_count; ++j)
-			{
-				Entity* e2 = &state->entities[j];
+// brings the world partition up to date with the current entity positions
+static void world_partition_update(GameState* state)
+{
+	if(state->world_partition.incremental)
+		world_partition_update_incremental(state, true);
+	else
+		world_partition_build(state);
+}
 
-				if(itu_lib_overlaps_circle_circle(
-					e1->position + e1->collider_offset, e1->collider_radius,
-					e2->position + e2->collider_offset, e2->collider_radius
-				))
-				{
-					if(state->frame_collisions_count >= MAX_COLLISIONS)
-					{
-						SDL_Log("[WARNING] too many collisions!");
-						return;
-					}
+// throws away all the cached cell data and reassigns every entity
+// (needed after changing mode, number of splits, or entities)
+static void world_partition_reset(GameState* state)
+{
+	WorldPartition* partition = &state->world_partition;
+	if(partition->splits == 0)
+		return;
 
-					// NOTE: here we are redoing a bunch of work that we already done in the overlap test. An easy optimization is do to have the test return the collision info
-					vec2f v = (e2->position + e2->collider_offset) - (e1->position + e1->collider_offset);
-					float l = length(v);
-					float separation_vector = e1->collider_radius + e2->collider_radius - l;
-					int new_collision_idx = state->frame_collisions_count++;
+	if(partition->buckets_count != state->layer_buckets.count)
+		world_partition_set_bins(partition, state->layer_buckets.count);
 
-					state->frame_collisions[new_collision_idx].e1 = e1;
-					state->frame_collisions[new_collision_idx].e2 = e2;
-					state->frame_collisions[new_collision_idx].normal = v / l; // normalize vector (we already need the length, so we don't need to call normalize which would do that anyway)
-					state->frame_collisions[new_collision_idx].separation = separation_vector;
-				}
-			}
+	if(partition->incremental)
+	{
+		for(int i = 0; i < partition->bins_count; ++i)
+			partition->cells[i].count = 0;
+
+		// put every link back in the free list
+		for(int i = 0; i < partition->memberships_capacity; ++i)
+			partition->memberships[i].next = i + 1 < partition->memberships_capacity ? i + 1 : WORLD_PARTITION_INVALID_IDX;
+		partition->memberships_free = partition->memberships_capacity > 0 ? 0 : WORLD_PARTITION_INVALID_IDX;
+
+		// an empty range (min > max) makes the next update insert every entity
+		const WorldPartitionRange range_empty = { 1, 1, 0, 0 };
+		for(int i = 0; i < ENTITY_COUNT; ++i)
+		{
+			partition->entity_ranges[i] = range_empty;
+			partition->entity_memberships[i] = WORLD_PARTITION_INVALID_IDX;
 		}
+
+		world_partition_update_incremental(state, false);
+		return;
 	}
+
+	world_partition_build(state);
 }
 
-static void collision_separate(GameState* state)
+// returns the entities referenced by the given bin
+static Uint32* world_partition_get_bin(WorldPartition* partition, int bin_idx, int* out_count)
 {
-	for(int i = 0; i < state->frame_collisions_count; ++i)
+	if(partition->incremental)
 	{
-		EntityCollisionInfo entity_collision_info = state->frame_collisions[i];
+		*out_count = partition->cells[bin_idx].count;
+		return partition->cells[bin_idx].entity_idxs;
+	}
 
-		vec2f sep = entity_collision_info.normal * entity_collision_info.separation;
+	*out_count = partition->cell_start[bin_idx + 1] - partition->cell_start[bin_idx];
+	return partition->entity_idxs + partition->cell_start[bin_idx];
+}
 
-		// NOTE: for an entity to be static, it must never move!
-		//       Otherwise, it will phase through other static entities when moved by a dynamic collider.
-		// TMP added reflection vectors
-		if(entity_collision_info.e2->collider_is_static)
-		{
-			entity_collision_info.e1->position -= sep;
-		}
-		else
-		{
-			sep = sep / 2;
-			entity_collision_info.e1->position -= sep;
-			entity_collision_info.e2->position += sep;
-		}
+#ifndef COLLISIONS_HEADLESS
+// returns the number of entities referenced by the given cell, all buckets together
+static int world_partition_get_cell_count(WorldPartition* partition, int cell_idx)
+{
+	int ret = 0;
+	for(int bucket = 0; bucket < partition->buckets_count; ++bucket)
+	{
+		int count;
+		world_partition_get_bin(partition, world_partition_get_bin_idx(partition, cell_idx, bucket), &count);
+		ret += count;
+	}
+	return ret;
+}
 
+// returns the total number of entity<>cell references
+static int world_partition_get_refs_count(WorldPartition* partition)
+{
+	if(!partition->incremental)
+		return partition->cell_start[partition->bins_count];
+
+	int ret = 0;
+	for(int i = 0; i < partition->bins_count; ++i)
+		ret += partition->cells[i].count;
+	return ret;
+}
+
+// fancy debug visualization for an incredibly simple world partition
+// the code is a mess tho, we will try to make it better when we talk about UIs
+static void world_partition_debug_cells(SDLContext* context, GameState* state)
+{
+	WorldPartition* partition = &state->world_partition;
+	if(partition->splits == 0)
+		return;
+
+	// render cell boundaries
+	SDL_SetRenderDrawColor(context->renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+	for(int i = 0; i < partition->cells_count; ++i)
+	{
+		vec2f cell_min = { (i % partition->splits) * partition->cell_size.x, (i / partition->splits) * partition->cell_size.y };
+		SDL_FRect rect = { cell_min.x, cell_min.y, partition->cell_size.x, partition->cell_size.y };
+		SDL_RenderRect(context->renderer, &rect);
+	}
+
+	// NOTE: one line per cell stops being readable (or fitting the screen) quite fast
+	const int cells_rendered_max = 64;
+	int cells_rendered = SDL_min(partition->cells_count, cells_rendered_max);
+
+	// render cell debug info
+	SDL_SetRenderDrawColor(context->renderer, 0x0, 0x00, 0x00, 0xCC);
+	SDL_FRect rect = SDL_FRect{ 250, 5, 230 + 225, cells_rendered * 10.0f + 35.0f };
+	SDL_RenderFillRect(context->renderer, &rect);
+
+	SDL_SetRenderDrawColor(context->renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+	SDL_RenderDebugText(context->renderer, 255, 10, "cell   entities   rect min          rect max");
+	SDL_RenderLine(context->renderer, 255, 20, 250+230 + 220, 20);
+
+	float base_text_render_y = 40;
+	for(int i = 0; i < cells_rendered; ++i)
+	{
+		vec2f cell_min = { (i % partition->splits) * partition->cell_size.x, (i / partition->splits) * partition->cell_size.y };
+		vec2f cell_max = cell_min + partition->cell_size;
+		int   cell_count = world_partition_get_cell_count(partition, i);
+		SDL_RenderDebugTextFormat(
+			context->renderer, 255, base_text_render_y + 10 * i,
+			"%4d   %4d       (%6.1f, %6.1f)   (%6.1f,  %6.1f)",
+			i, cell_count, cell_min.x, cell_min.y, cell_max.x, cell_max.y
+		);
 	}
+	SDL_RenderDebugTextFormat(
+		context->renderer, 255, base_text_render_y -15,
+		" tot   %4d       (%d cells, %d movers)",
+		world_partition_get_refs_count(partition), partition->cells_count, partition->movers_count
+	);
+	SDL_RenderLine(context->renderer, 255, base_text_render_y-5, 250+230 + 220, base_text_render_y + -5);
 }
+#endif
 
 // ********************************************************************************************************************
-// game
+// sweep and prune
 // ********************************************************************************************************************
 
-static void game_init(SDLContext* context, GameState* state)
+// NOTE: unlike the world partition, there is nothing to tune and nothing to clamp, entities can go anywhere.
+//       The trade-off is that we only prune on one axis, so it gets worse when a lot of entities line up vertically
+
+struct SweepAndPruneEndpoint
 {
-	state->entities = (Entity*)SDL_calloc(ENTITY_COUNT, sizeof(Entity));
-	SDL_assert(state->entities);
+	float  value;
+	Uint32 entity_idx;
+	bool   is_max;
+	Uint8  bucket; // layer bucket of the entity, fits in the padding
+};
 
-	state->frame_collisions = (EntityCollisionInfo*)SDL_calloc(MAX_COLLISIONS, sizeof(EntityCollisionInfo));
-	SDL_assert(state->frame_collisions);
+static inline bool sweep_and_prune_endpoint_less(SweepAndPruneEndpoint a, SweepAndPruneEndpoint b)
+{
+	// NOTE: on ties, closing endpoints go first. Overlap tests use strict inequalities,
+	//       so intervals that are just touching should not be considered overlapping
+	return a.value < b.value || (a.value == b.value && a.is_max && !b.is_max);
+}
 
-	const int num_cells = 4;
+static int sweep_and_prune_endpoint_compare(const void* a, const void* b)
+{
+	SweepAndPruneEndpoint* ea = (SweepAndPruneEndpoint*)a;
+	SweepAndPruneEndpoint* eb = (SweepAndPruneEndpoint*)b;
+	if(sweep_and_prune_endpoint_less(*ea, *eb))
+		return -1;
+	if(sweep_and_prune_endpoint_less(*eb, *ea))
+		return 1;
+	return 0;
+}
 
-	// world partitioning data allocation
-	{
-		// we will split out game world in WORLD_PARTITION_CELL_SPLITS vertically and WORLD_PARTITION_CELL_SPLITS horizontally
-		state->world_partition_cells_count = WORLD_PARTITION_CELL_SPLITS * WORLD_PARTITION_CELL_SPLITS;
+static inline float sweep_and_prune_endpoint_value(Entity* entity, bool is_max)
+{
+	float x = entity->position.x + entity->collider_offset.x;
+	return is_max ? x + entity->collider_radius : x - entity->collider_radius;
+}
+
+// refreshes the endpoint values and sorts them again
+// NOTE: entities move very little between frames, so the list is almost sorted already. Insertion sort is O(N^2) in general,
+//       but on an almost sorted list it's O(N + number of swaps), which is way better than any general purpose sort
+static void sweep_and_prune_update(GameState* state)
+{
+	SweepAndPrune* sap = &state->sweep_and_prune;
+	SweepAndPruneEndpoint* endpoints = sap->endpoints;
 
-		// allocate one integer for each cell (to know how many entities actually reside here)
-		state->world_partition_cells = (WorldPartitionCell*)SDL_calloc(state->world_partition_cells_count, sizeof(WorldPartitionCell));
+	// NOTE: sleeping entities didn't move, their endpoints are still good
+	for(int i = 0; i < sap->endpoints_count; ++i)
+	{
+		Entity* entity = &state->entities[endpoints[i].entity_idx];
+		if(!entity_is_still(entity))
+			endpoints[i].value = sweep_and_prune_endpoint_value(entity, endpoints[i].is_max);
+	}
 
-		// allocate actual array of references for the entities
-		for(int i = 0; i < state->world_partition_cells_count; ++i)
+	sap->swaps_count = 0;
+	for(int i = 1; i < sap->endpoints_count; ++i)
+	{
+		SweepAndPruneEndpoint endpoint = endpoints[i];
+		int j = i - 1;
+		while(j >= 0 && sweep_and_prune_endpoint_less(endpoint, endpoints[j]))
 		{
-			WorldPartitionCell* cell = &state->world_partition_cells[i];
-			cell->entity_refs = (Entity**)SDL_calloc(WORLD_PARTITION_CELL_MAX_ENTITY_COUNT, sizeof(Entity*));
+			endpoints[j + 1] = endpoints[j];
+			--j;
 		}
+		endpoints[j + 1] = endpoint;
+		sap->swaps_count += i - 1 - j;
 	}
-
-	// texture atlases
-	state->atlas = texture_create(context, "../data/kenney/simpleSpace_tilesheet_2.png");
-
 }
 
-static void game_reset(SDLContext* context, GameState* state)
+// recreates the endpoints list from scratch (needed when entities are added or removed)
+static void sweep_and_prune_reset(GameState* state)
 {
-	// entities
+	SweepAndPrune* sap = &state->sweep_and_prune;
+
+	sap->endpoints_count = 0;
+	for(int i = 0; i < state->entities_alive_count; ++i)
+	{
+		Entity* entity = &state->entities[i];
+		if(entity->collider_is_static)
+			continue;
+
+		Uint8 bucket = (Uint8)collision_layer_bucket(&state->layer_buckets, entity);
+		sap->endpoints[sap->endpoints_count++] = SweepAndPruneEndpoint{ sweep_and_prune_endpoint_value(entity, false), (Uint32)i, false, bucket };
+		sap->endpoints[sap->endpoints_count++] = SweepAndPruneEndpoint{ sweep_and_prune_endpoint_value(entity, true),  (Uint32)i, true,  bucket };
+	}
+
+	// a bucket can't have more intervals open at the same time than it has members
+	int total = 0;
+	for(int i = 0; i < state->layer_buckets.count; ++i)
+	{
+		sap->active_start[i] = total;
+		total += state->layer_buckets.members_count[i];
+	}
+
+	// the first sort has no coherence to exploit, use a proper sort instead
+	SDL_qsort(sap->endpoints, sap->endpoints_count, sizeof(SweepAndPruneEndpoint), sweep_and_prune_endpoint_compare);
+	sap->swaps_count = 0;
+}
+
+// ********************************************************************************************************************
+// bvh
+// ********************************************************************************************************************
+
+// NOTE: all the heavy lifting is done by itu_lib_bvh, here we just keep it in sync with the entities
+
+static Shape bvh_entity_shape(Entity* entity)
+{
+	return itu_lib_overlaps_shape_circle(entity->position + entity->collider_offset, entity->collider_radius);
+}
+
+static void bvh_update(GameState* state)
+{
+	state->bvh_reinserts_count = 0;
+	for(int i = 0; i < state->entities_alive_count; ++i)
+	{
+		if(state->entities[i].collider_is_static || entity_is_still(&state->entities[i]))
+			continue;
+
+		Shape shape = bvh_entity_shape(&state->entities[i]);
+		if(itu_lib_bvh_move(&state->bvh, state->bvh_leaves[i], &shape))
+			state->bvh_reinserts_count++;
+	}
+}
+
+static void bvh_reset(GameState* state)
+{
+	itu_lib_bvh_clear(&state->bvh);
+	for(int i = 0; i < state->entities_alive_count; ++i)
+	{
+		if(state->entities[i].collider_is_static)
+			continue;
+
+		Entity* entity = &state->entities[i];
+		Shape shape = bvh_entity_shape(entity);
+		state->bvh_leaves[i] = itu_lib_bvh_insert(&state->bvh, &shape, i);
+		itu_lib_bvh_set_filter(&state->bvh, state->bvh_leaves[i], entity->collider_layer, entity->collider_mask);
+	}
+	state->bvh_reinserts_count = 0;
+}
+
+#ifndef COLLISIONS_HEADLESS
+static void bvh_debug_nodes(SDLContext* context, GameState* state)
+{
+	BVH* bvh = &state->bvh;
+	for(int i = 0; i < bvh->nodes_capacity; ++i)
+	{
+		BVHNode* node = &bvh->nodes[i];
+
+		// skip free nodes and leaves (we already render the colliders)
+		if(node->height <= 0)
+			continue;
+
+		// higher nodes are more opaque
+		color c = COLOR_YELLOW;
+		c.a = SDL_min(0.2f + node->height * 0.08f, 1.0f);
+		itu_lib_render_draw_rect(context->renderer, node->aabb_min, node->aabb_max - node->aabb_min, c);
+	}
+}
+#endif
+
+// ********************************************************************************************************************
+// static colliders
+// ********************************************************************************************************************
+
+static void static_grid_get_cell(StaticGrid* grid, vec2f p, int* out_x, int* out_y)
+{
+	// NOTE: everything outside of the window gets clamped to the border cells
+	*out_x = SDL_clamp((int)(p.x / grid->cell_size.x), 0, grid->splits - 1);
+	*out_y = SDL_clamp((int)(p.y / grid->cell_size.y), 0, grid->splits - 1);
+}
+
+// bins all static entities with a counting sort (see `world_partition_build()`), only needed when statics are added or removed
+static void static_grid_build(GameState* state)
+{
+	StaticGrid* grid = &state->static_grid;
+	int cells_count = grid->splits * grid->splits;
+	int* cell_start = grid->cell_start;
+
+	// 1. count
+	SDL_memset(cell_start, 0, (cells_count + 1) * sizeof(int));
+	grid->radius_max = 0;
+	grid->layers = 0;
+	grid->masks  = 0;
+	for(int i = 0; i < state->entities_alive_count; ++i)
+	{
+		Entity* entity = &state->entities[i];
+		if(!entity->collider_is_static)
+			continue;
+
+		int x, y;
+		static_grid_get_cell(grid, entity->position + entity->collider_offset, &x, &y);
+		cell_start[x + y * grid->splits]++;
+		grid->radius_max = SDL_max(grid->radius_max, entity->collider_radius);
+		grid->layers |= entity->collider_layer;
+		grid->masks  |= entity->collider_mask;
+	}
+
+	// 2. prefix sum
+	int total = 0;
+	for(int i = 0; i < cells_count; ++i)
+	{
+		int count = cell_start[i];
+		cell_start[i] = total;
+		grid->cell_cursor[i] = total;
+		total += count;
+	}
+	cell_start[cells_count] = total;
+	grid->count = total;
+
+	// 3. scatter (colliders too, they never change)
+	for(int i = 0; i < state->entities_alive_count; ++i)
+	{
+		Entity* entity = &state->entities[i];
+		if(!entity->collider_is_static)
+			continue;
+
+		vec2f center = entity->position + entity->collider_offset;
+		int x, y;
+		static_grid_get_cell(grid, center, &x, &y);
+		int slot = grid->cell_cursor[x + y * grid->splits]++;
+		grid->entity_idxs[slot] = (Uint32)i;
+		grid->x[slot]           = center.x;
+		grid->y[slot]           = center.y;
+		grid->radius[slot]      = entity->collider_radius;
+	}
+}
+
+// ********************************************************************************************************************
+// broadphase
+// ********************************************************************************************************************
+
+// brings the active broadphase up to date with the current entity positions
+// NOTE: call this after moving entities and before `collision_check()`, which trusts the broadphase blindly
+static void broadphase_update(GameState* state)
+{
+	switch(state->broadphase)
+	{
+		case BROADPHASE_TYPE_WORLD_PARTITION:
+			if(state->world_partition.splits > 0)
+				world_partition_update(state);
+			break;
+		case BROADPHASE_TYPE_SWEEP_AND_PRUNE:
+			sweep_and_prune_update(state);
+			break;
+		case BROADPHASE_TYPE_BVH:
+			bvh_update(state);
+			break;
+		default: SDL_assert(false);
+	}
+
+	// the broadphase has seen where the new sleepers stopped, from now on it can skip them
+	if(state->dozing_count > 0)
+	{
+		for(int i = 0; i < state->entities_alive_count; ++i)
+			state->entities[i].is_dozing = false;
+		state->dozing_count = 0;
+	}
+}
+
+// rebuilds the active broadphase from scratch
+static void broadphase_reset(GameState* state)
+{
+	collision_layer_buckets_update(state);
+
+	switch(state->broadphase)
+	{
+		case BROADPHASE_TYPE_WORLD_PARTITION: world_partition_reset(state); break;
+		case BROADPHASE_TYPE_SWEEP_AND_PRUNE: sweep_and_prune_reset(state); break;
+		case BROADPHASE_TYPE_BVH:             bvh_reset(state);             break;
+		default: SDL_assert(false);
+	}
+}
+
+// ********************************************************************************************************************
+// collisions
+// ********************************************************************************************************************
+
+struct EntityCollisionInfo
+{
+	Entity* e1;
+	Entity* e2;
+
+	vec2f normal;
+	float separation;
+};
+
+struct ContactBlock
+{
+	ContactBlock*       next;
+	int                 count;
+	EntityCollisionInfo contacts[CONTACT_BLOCK_SIZE];
+};
+
+static void contact_stream_push(ContactStream* stream, Arena* arena, EntityCollisionInfo* infos, int count)
+{
+	while(count > 0)
+	{
+		ContactBlock* block = stream->last;
+		if(!block || block->count == CONTACT_BLOCK_SIZE)
+		{
+			block = itu_lib_arena_alloc_array(arena, ContactBlock, 1);
+			block->next  = NULL;
+			block->count = 0;
+			if(stream->last)
+				stream->last->next = block;
+			else
+				stream->first = block;
+			stream->last = block;
+		}
+
+		int copy_count = SDL_min(count, CONTACT_BLOCK_SIZE - block->count);
+		SDL_memcpy(block->contacts + block->count, infos, copy_count * sizeof(EntityCollisionInfo));
+		block->count  += copy_count;
+		stream->count += copy_count;
+		infos += copy_count;
+		count -= copy_count;
+	}
+}
+
+// data kept for each colliding pair as long as it keeps colliding
+struct CollisionPair
+{
+	float separation_total; // sum of all separations applied to this pair (a positional "accumulated impulse")
+	int   frames_count;     // consecutive frames the pair has been colliding for
+};
+
+// a contact, as seen by the separation solver. Penetration is measured again from the current positions at every iteration,
+// so contacts of the same entity don't push it twice for the same overlap
+struct SeparationConstraint
+{
+	Uint32 entity_idx_1;
+	Uint32 entity_idx_2;
+	vec2f  normal;       // from the narrowphase, only used if the centers end up on top of each other
+};
+
+// a range of constraints of the same color, split in jobs
+struct SeparationBatch
+{
+	GameState*            state;
+	SeparationConstraint* constraints;
+	int                   count;
+};
+
+// collisions found by a single job of the parallel narrowphase (see `collision_check()`)
+struct CollisionJob
+{
+	int cell_beg;
+	int cell_end;
+
+	EntityCollisionInfo* collisions; // grows as needed, only the job that owns it writes here
+	int                  collisions_count;
+	int                  collisions_capacity;
+
+	// scratch memory: colliders of the cell being checked (all of its bins, one after the other), in SoA layout for `itu_lib_overlaps_circle_circles()`
+	float*  cell_x;
+	float*  cell_y;
+	float*  cell_radius;
+	int*    cell_hits;
+	Uint32* cell_entity_idxs;
+	int     cell_capacity;
+};
+
+static inline bool collision_layers_match(Entity* e1, Entity* e2)
+{
+	return (e1->collider_layer & e2->collider_mask) && (e2->collider_layer & e1->collider_mask);
+}
+
+// pairs where nobody is awake: both sleeping, or sleeping against a static. Nothing moved, so there is nothing new to find
+static inline bool collision_pair_is_asleep(Entity* e1, Entity* e2)
+{
+	return (e1->is_sleeping || e1->collider_is_static) && (e2->is_sleeping || e2->collider_is_static);
+}
+
+// tests a single pair, and fills the collision info if they overlap
+// NOTE: this only reads entities, so it is safe to call from multiple threads at the same time
+static bool collision_test_pair(Entity* e1, Entity* e2, EntityCollisionInfo* out_info)
+{
+	Contact contact;
+	if(!itu_lib_collide_circle_circle(
+		e1->position + e1->collider_offset, e1->collider_radius,
+		e2->position + e2->collider_offset, e2->collider_radius,
+		&contact
+	))
+		return false;
+
+	// // epilepsy warning right there
+	// e1->sprite.tint = COLOR_RED;
+	// e2->sprite.tint = COLOR_RED;
+
+	out_info->e1 = e1;
+	out_info->e2 = e2;
+	out_info->normal = contact.normal;
+	out_info->separation = contact.depth;
+	return true;
+}
+
+// tests a single pair, and stores the collision info if they overlap
+static void collision_check_pair(GameState* state, Entity* e1, Entity* e2)
+{
+	if(!collision_layers_match(e1, e2) || collision_pair_is_asleep(e1, e2))
+		return;
+
+	EntityCollisionInfo info;
+	if(collision_test_pair(e1, e2, &info))
+		contact_stream_push(&state->frame_collisions, &state->frame_arena, &info, 1);
+}
+
+// same as `collision_check_pair()`, for broadphases that report pairs in no particular order
+// (the dynamic entity must come first, and static entities never collide with each other)
+static void collision_check_pair_unordered(GameState* state, Entity* e1, Entity* e2)
+{
+	if(e1->collider_is_static && e2->collider_is_static)
+		return;
+
+	if(e1->collider_is_static)
+		collision_check_pair(state, e2, e1);
+	else
+		collision_check_pair(state, e1, e2);
+}
+
+static void collision_job_push(CollisionJob* job, EntityCollisionInfo info)
+{
+	if(job->collisions_count == job->collisions_capacity)
+	{
+		job->collisions_capacity = SDL_max(job->collisions_capacity * 2, 64);
+		job->collisions = (EntityCollisionInfo*)SDL_realloc(job->collisions, job->collisions_capacity * sizeof(EntityCollisionInfo));
+		SDL_assert(job->collisions);
+	}
+	job->collisions[job->collisions_count++] = info;
+}
+
+// tests the entities of a single cell against each other.
+// The bins of the cell are checked bucket against bucket, and pairs of buckets that can't collide are skipped whole
+static void collision_check_references(GameState* state, CollisionJob* job, int cell_idx)
+{
+	WorldPartition*        partition = &state->world_partition;
+	CollisionLayerBuckets* buckets   = &state->layer_buckets;
+
+	// `bucket_start[b]` is where the entities of bucket `b` begin in the scratch arrays
+	int bucket_start[COLLISION_LAYER_BUCKETS_MAX + 1];
+	int entity_idxs_count = 0;
+	for(int b = 0; b < partition->buckets_count; ++b)
+	{
+		int count;
+		world_partition_get_bin(partition, world_partition_get_bin_idx(partition, cell_idx, b), &count);
+		bucket_start[b] = entity_idxs_count;
+		entity_idxs_count += count;
+	}
+	bucket_start[partition->buckets_count] = entity_idxs_count;
+
+	if(entity_idxs_count < 2)
+		return;
+
+	// copy the colliders of the cell in SoA layout, so each entity can be tested against a whole bucket in one batch
+	if(job->cell_capacity < entity_idxs_count)
+	{
+		job->cell_capacity = SDL_max(job->cell_capacity * 2, entity_idxs_count);
+		job->cell_x           = (float*) SDL_realloc(job->cell_x,           job->cell_capacity * sizeof(float));
+		job->cell_y           = (float*) SDL_realloc(job->cell_y,           job->cell_capacity * sizeof(float));
+		job->cell_radius      = (float*) SDL_realloc(job->cell_radius,      job->cell_capacity * sizeof(float));
+		job->cell_hits        = (int*)   SDL_realloc(job->cell_hits,        job->cell_capacity * sizeof(int));
+		job->cell_entity_idxs = (Uint32*)SDL_realloc(job->cell_entity_idxs, job->cell_capacity * sizeof(Uint32));
+		SDL_assert(job->cell_x && job->cell_y && job->cell_radius && job->cell_hits && job->cell_entity_idxs);
+	}
+
+	Uint32* entity_idxs = job->cell_entity_idxs;
+	int awake_count = 0;
+	for(int b = 0; b < partition->buckets_count; ++b)
+	{
+		int     bin_count;
+		Uint32* bin_entity_idxs = world_partition_get_bin(partition, world_partition_get_bin_idx(partition, cell_idx, b), &bin_count);
+		for(int k = 0; k < bin_count; ++k)
+		{
+			int i = bucket_start[b] + k;
+			Entity* e = &state->entities[bin_entity_idxs[k]];
+			vec2f center = e->position + e->collider_offset;
+			entity_idxs[i]      = bin_entity_idxs[k];
+			job->cell_x[i]      = center.x;
+			job->cell_y[i]      = center.y;
+			job->cell_radius[i] = e->collider_radius;
+			awake_count += !e->is_sleeping;
+		}
+	}
+
+	// the whole cell is asleep, nothing to find here
+	if(awake_count == 0)
+		return;
+
+	int cell_x = cell_idx % partition->splits;
+	int cell_y = cell_idx / partition->splits;
+
+	for(int b1 = 0; b1 < partition->buckets_count; ++b1)
+	{
+		// every pair of buckets is checked once, from the lowest one
+		Uint32 compatible = buckets->compatible[b1] >> b1 << b1;
+		if(compatible == 0)
+			continue;
+
+		for(int i = bucket_start[b1]; i < bucket_start[b1 + 1]; ++i)
+		{
+			Entity* e1 = &state->entities[entity_idxs[i]];
+
+			if(e1->collider_is_static)
+				continue;
+
+			WorldPartitionRange range_1 = partition->entity_ranges[entity_idxs[i]];
+			for(int b2 = b1; b2 < partition->buckets_count; ++b2)
+			{
+				if(!(compatible & (1u << b2)))
+					continue;
+
+				int first = b2 == b1 ? i + 1 : bucket_start[b2];
+				int last  = bucket_start[b2 + 1];
+				if(first >= last)
+					continue;
+
+				int hits_count = itu_lib_overlaps_circle_circles(
+					vec2f{ job->cell_x[i], job->cell_y[i] }, job->cell_radius[i],
+					job->cell_x + first, job->cell_y + first, job->cell_radius + first, last - first,
+					job->cell_hits
+				);
+
+				for(int h = 0; h < hits_count; ++h)
+				{
+					// NOTE: checking ownership only on hits keeps the batch test branch-free, and it's just a couple of compares.
+					//       Layers are still checked per pair, a compatible bucket only means that some of its members can collide
+					Uint32  entity_idx_2 = entity_idxs[first + job->cell_hits[h]];
+					Entity* e2 = &state->entities[entity_idx_2];
+					if(!world_partition_cell_owns_pair(range_1, partition->entity_ranges[entity_idx_2], cell_x, cell_y) || !collision_layers_match(e1, e2))
+						continue;
+					if(collision_pair_is_asleep(e1, e2))
+						continue;
+
+					// NOTE: the batch test does the same math as the contact test, so this never fails.
+					//       We only pay for the square root of the pairs that actually collide
+					EntityCollisionInfo info;
+					if(collision_test_pair(e1, e2, &info))
+						collision_job_push(job, info);
+				}
+			}
+		}
+	}
+}
+
+// runs on any thread of `GameState::jobs`, checks a contiguous range of cells
+static void collision_check_cells_job(void* userdata, int job_idx, int thread_idx)
+{
+	GameState*    state = (GameState*)userdata;
+	CollisionJob* job   = &state->collision_jobs[job_idx];
+
+	job->collisions_count = 0;
+	for(int i = job->cell_beg; i < job->cell_end; ++i)
+		collision_check_references(state, job, i);
+}
+
+// sweeps the (already sorted) endpoints from left to right, keeping track of the intervals that are currently open.
+// When an interval opens, it overlaps on the x axis with every interval that is still open, and only those pairs get tested
+// (skipping the active lists of the layer buckets it can't collide with)
+static void collision_check_sweep_and_prune(GameState* state)
+{
+	SweepAndPrune*         sap     = &state->sweep_and_prune;
+	CollisionLayerBuckets* buckets = &state->layer_buckets;
+	SDL_memset(sap->active_count, 0, sizeof(sap->active_count));
+
+	for(int i = 0; i < sap->endpoints_count; ++i)
+	{
+		SweepAndPruneEndpoint endpoint = sap->endpoints[i];
+		Uint32* active = sap->active + sap->active_start[endpoint.bucket];
+
+		if(endpoint.is_max)
+		{
+			// interval closed, swap-remove it from the active list
+			Uint32 slot = sap->active_slots[endpoint.entity_idx];
+			Uint32 last = active[--sap->active_count[endpoint.bucket]];
+			active[slot] = last;
+			sap->active_slots[last] = slot;
+			continue;
+		}
+
+		Entity* e = &state->entities[endpoint.entity_idx];
+		for(int b = 0; b < buckets->count; ++b)
+		{
+			if(!(buckets->compatible[endpoint.bucket] & (1u << b)))
+				continue;
+
+			Uint32* others = sap->active + sap->active_start[b];
+			for(int j = 0; j < sap->active_count[b]; ++j)
+			{
+				Entity* other = &state->entities[others[j]];
+				collision_check_pair_unordered(state, e, other);
+			}
+		}
+
+		sap->active_slots[endpoint.entity_idx] = sap->active_count[endpoint.bucket];
+		active[sap->active_count[endpoint.bucket]++] = endpoint.entity_idx;
+	}
+}
+
+static bool collision_check_bvh_pair(void* userdata, Uint32 entity_idx_0, Uint32 entity_idx_1)
+{
+	GameState* state = (GameState*)userdata;
+	collision_check_pair_unordered(state, &state->entities[entity_idx_0], &state->entities[entity_idx_1]);
+	return true;
+}
+
+// tests every dynamic entity against the statics around it
+static void collision_check_statics(GameState* state)
+{
+	StaticGrid* grid = &state->static_grid;
+	if(grid->count == 0)
+		return;
+
+	for(int i = 0; i < state->entities_alive_count; ++i)
+	{
+		Entity* e1 = &state->entities[i];
+		if(e1->collider_is_static || e1->is_sleeping)
+			continue;
+
+		// no static can collide with this entity, don't even look at the grid
+		if(!(e1->collider_layer & grid->masks) || !(e1->collider_mask & grid->layers))
+			continue;
+
+		vec2f center = e1->position + e1->collider_offset;
+		float reach  = e1->collider_radius + grid->radius_max;
+		int min_x, min_y, max_x, max_y;
+		static_grid_get_cell(grid, center - reach, &min_x, &min_y);
+		static_grid_get_cell(grid, center + reach, &max_x, &max_y);
+
+		for(int y = min_y; y <= max_y; ++y)
+		{
+			// cells of the same row are next to each other, test all their statics in one go
+			int beg = grid->cell_start[min_x     + y * grid->splits];
+			int end = grid->cell_start[max_x + 1 + y * grid->splits];
+			int hits_count = itu_lib_overlaps_circle_circles(
+				center, e1->collider_radius,
+				grid->x + beg, grid->y + beg, grid->radius + beg, end - beg,
+				grid->hits
+			);
+
+			for(int h = 0; h < hits_count; ++h)
+			{
+				Entity* e2 = &state->entities[grid->entity_idxs[beg + grid->hits[h]]];
+				collision_check_pair(state, e1, e2);
+			}
+		}
+	}
+}
+
+// tests dynamic entities against each other, using the current broadphase
+static void collision_check_dynamic(GameState* state)
+{
+	if(state->broadphase == BROADPHASE_TYPE_SWEEP_AND_PRUNE)
+	{
+		collision_check_sweep_and_prune(state);
+		return;
+	}
+
+	if(state->broadphase == BROADPHASE_TYPE_BVH)
+	{
+		itu_lib_bvh_query_pairs(&state->bvh, collision_check_bvh_pair, state);
+		return;
+	}
+
+	WorldPartition* partition = &state->world_partition;
+	if(partition->splits > 0)
+	{
+		// world partition
+		// cells are only read here, so they are split in jobs and checked in parallel, each job writing in its own buffer.
+		// Buffers are then merged in job order, which is the same as checking the cells one by one on a single thread
+		int jobs_count = SDL_min(partition->cells_count, COLLISION_JOBS_MAX);
+		for(int i = 0; i < jobs_count; ++i)
+		{
+			CollisionJob* job = &state->collision_jobs[i];
+			job->cell_beg = partition->cells_count *  i      / jobs_count;
+			job->cell_end = partition->cells_count * (i + 1) / jobs_count;
+		}
+		state->collision_jobs_count = jobs_count;
+
+		itu_lib_jobs_parallel_for(&state->jobs, jobs_count, collision_check_cells_job, state);
+
+		for(int i = 0; i < jobs_count; ++i)
+		{
+			CollisionJob* job = &state->collision_jobs[i];
+			contact_stream_push(&state->frame_collisions, &state->frame_arena, job->collisions, job->collisions_count);
+		}
+	}
+	else {
+		for(int i = 0; i < state->entities_alive_count - 1; ++i)
+		{
+			Entity* e1 = &state->entities[i];
+			if(e1->collider_is_static)
+				continue;
+
+			for(int j = i + 1; j < state->entities_alive_count; ++j)
+			{
+				Entity* e2 = &state->entities[j];
+				if(e2->collider_is_static)
+					continue;
+
+				collision_check_pair(state, e1, e2);
+			}
+		}
+	}
+}
+
+static void collision_check(GameState* state)
+{
+	// last frame's contacts are gone, all at once
+	itu_lib_arena_reset(&state->frame_arena);
+	state->frame_collisions = ContactStream{ };
+
+	collision_check_dynamic(state);
+	collision_check_statics(state);
+}
+
+// pairs the narrowphase skipped because they were asleep (even if they have just been woken up) are still touching
+// NOTE: worst case, a pair that just separated lasts one frame more than it should
+static bool collision_pair_keep(void* userdata, Uint32 entity_idx_0, Uint32 entity_idx_1)
+{
+	GameState* state = (GameState*)userdata;
+	Entity* e1 = &state->entities[entity_idx_0];
+	Entity* e2 = &state->entities[entity_idx_1];
+	return (e1->is_sleeping || e1->is_waking || e1->collider_is_static) && (e2->is_sleeping || e2->is_waking || e2->collider_is_static);
+}
+
+// feeds this frame's collisions to the pair cache, and reacts to pairs that started or stopped colliding.
+// NOTE: ongoing contacts only update their pair data, gameplay code doesn't need to look at them
+// NOTE: sleeping pairs are not tested, but they are still touching. They are kept as they are until somebody wakes them up
+static void collision_update_pairs(GameState* state)
+{
+	PairTable* pairs = &state->collision_pairs;
+	for(ContactBlock* block = state->frame_collisions.first; block; block = block->next)
+	{
+		for(int i = 0; i < block->count; ++i)
+		{
+			EntityCollisionInfo* info = &block->contacts[i];
+			Uint32 entity_idx_0 = (Uint32)(info->e1 - state->entities);
+			Uint32 entity_idx_1 = (Uint32)(info->e2 - state->entities);
+
+			CollisionPair* pair = (CollisionPair*)itu_lib_pairs_get(pairs, entity_idx_0, entity_idx_1, NULL);
+			pair->frames_count++;
+			if(DEBUG_separate_collisions)
+				pair->separation_total += info->separation;
+		}
+	}
+	itu_lib_pairs_keep(pairs, collision_pair_keep, state);
+	itu_lib_pairs_end_frame(pairs);
+
+	for(int i = 0; i < pairs->began.count; ++i)
+	{
+		PairEvent event = pairs->began.events[i];
+		state->entities[event.id_0].contacts_count++;
+		state->entities[event.id_1].contacts_count++;
+	}
+	for(int i = 0; i < pairs->ended.count; ++i)
+	{
+		PairEvent event = pairs->ended.events[i];
+		state->entities[event.id_0].contacts_count--;
+		state->entities[event.id_1].contacts_count--;
+	}
+}
+
+static void separation_solve(GameState* state, SeparationConstraint* constraint)
+{
+	Entity* e1 = &state->entities[constraint->entity_idx_1];
+	Entity* e2 = &state->entities[constraint->entity_idx_2];
+
+	vec2f d = (e2->position + e2->collider_offset) - (e1->position + e1->collider_offset);
+	float r = e1->collider_radius + e2->collider_radius;
+	float d_len_sq = length_sq(d);
+	if(d_len_sq >= r * r)
+		return;
+
+	float d_len  = SDL_sqrtf(d_len_sq);
+	vec2f normal = d_len > FLOAT_EPSILON ? d / d_len : constraint->normal;
+	vec2f sep    = normal * (r - d_len);
+
+	// NOTE: for an entity to be static, it must never move!
+	//       Otherwise, it will phase through other static entities when moved by a dynamic collider.
+	if(e2->collider_is_static)
+	{
+		e1->position -= sep;
+	}
+	else
+	{
+		sep = sep / 2;
+		e1->position -= sep;
+		e2->position += sep;
+	}
+}
+
+// runs on any thread of `GameState::jobs`, separates a chunk of a single color
+static void separation_job(void* userdata, int job_idx, int thread_idx)
+{
+	SeparationBatch* batch = (SeparationBatch*)userdata;
+
+	int beg = job_idx * SEPARATION_JOB_SIZE;
+	int end = SDL_min(beg + SEPARATION_JOB_SIZE, batch->count);
+	for(int i = beg; i < end; ++i)
+		separation_solve(batch->state, &batch->constraints[i]);
+}
+
+// pushes colliding entities apart, `separation_iterations` times.
+// Applying contacts one by one is inherently serial (two contacts of the same entity can't be applied at the same time), so:
+// 1. color the contact graph: every contact gets the lowest color not used yet by the contacts of its entities
+// 2. sort the contacts by color
+// 3. every color is a set of contacts that share no entity, so they can be applied in any order, on any thread
+// NOTE: statics never move, so they don't take colors (a wall touched by 100 entities doesn't need 100 colors)
+// NOTE: the order inside each color doesn't matter, so the result is the same with any number of threads
+static void collision_separate(GameState* state)
+{
+	int count = state->frame_collisions.count;
+	state->separation_colors_count   = 0;
+	state->separation_overflow_count = 0;
+	if(count == 0)
+		return;
+
+	// contacts live until the next `collision_check()`, and so does everything else allocated here
+	Arena* arena = &state->frame_arena;
+	Uint8*                contact_colors = itu_lib_arena_alloc_array(arena, Uint8, count);
+	SeparationConstraint* constraints    = itu_lib_arena_alloc_array(arena, SeparationConstraint, count);
+	Uint64*               entity_colors  = state->separation_entity_colors;
+
+	// color `SEPARATION_COLORS_MAX` is the overflow
+	int color_start[SEPARATION_COLORS_MAX + 2] = { 0 };
+	int color_cursor[SEPARATION_COLORS_MAX + 1];
+
+	// 1. greedy coloring
+	int contact_idx = 0;
+	for(ContactBlock* block = state->frame_collisions.first; block; block = block->next)
+	{
+		for(int i = 0; i < block->count; ++i)
+		{
+			EntityCollisionInfo* info = &block->contacts[i];
+			Uint32 idx_1 = (Uint32)(info->e1 - state->entities);
+			Uint32 idx_2 = (Uint32)(info->e2 - state->entities);
+			bool   is_static = info->e2->collider_is_static;
+
+			Uint64 used = entity_colors[idx_1] | (is_static ? 0 : entity_colors[idx_2]);
+			int color = 0;
+			while(color < SEPARATION_COLORS_MAX && (used >> color) & 1)
+				color++;
+
+			if(color < SEPARATION_COLORS_MAX)
+			{
+				entity_colors[idx_1] |= 1ull << color;
+				if(!is_static)
+					entity_colors[idx_2] |= 1ull << color;
+			}
+			contact_colors[contact_idx++] = (Uint8)color;
+			color_start[color + 1]++;
+		}
+	}
+
+	// 2. counting sort by color
+	for(int c = 0; c <= SEPARATION_COLORS_MAX; ++c)
+	{
+		color_start[c + 1] += color_start[c];
+		color_cursor[c] = color_start[c];
+	}
+
+	contact_idx = 0;
+	for(ContactBlock* block = state->frame_collisions.first; block; block = block->next)
+	{
+		for(int i = 0; i < block->count; ++i)
+		{
+			EntityCollisionInfo* info = &block->contacts[i];
+			SeparationConstraint* constraint = &constraints[color_cursor[contact_colors[contact_idx++]]++];
+			constraint->entity_idx_1 = (Uint32)(info->e1 - state->entities);
+			constraint->entity_idx_2 = (Uint32)(info->e2 - state->entities);
+			constraint->normal       = info->normal;
+
+			// NOTE: only the entities we touched have colors, clearing them here is cheaper than clearing the whole array
+			entity_colors[constraint->entity_idx_1] = 0;
+			entity_colors[constraint->entity_idx_2] = 0;
+		}
+	}
+
+	for(int c = 0; c < SEPARATION_COLORS_MAX; ++c)
+		if(color_start[c + 1] > color_start[c])
+			state->separation_colors_count = c + 1;
+	state->separation_overflow_count = color_start[SEPARATION_COLORS_MAX + 1] - color_start[SEPARATION_COLORS_MAX];
+
+	// 3. solve, one color at a time
+	for(int it = 0; it < state->separation_iterations; ++it)
+	{
+		for(int c = 0; c < state->separation_colors_count; ++c)
+		{
+			SeparationBatch batch;
+			batch.state       = state;
+			batch.constraints = constraints + color_start[c];
+			batch.count       = color_start[c + 1] - color_start[c];
+
+			int jobs_count = (batch.count + SEPARATION_JOB_SIZE - 1) / SEPARATION_JOB_SIZE;
+			itu_lib_jobs_parallel_for(&state->jobs, jobs_count, separation_job, &batch);
+		}
+
+		for(int i = color_start[SEPARATION_COLORS_MAX]; i < color_start[SEPARATION_COLORS_MAX + 1]; ++i)
+			separation_solve(state, &constraints[i]);
+	}
+}
+
+// ********************************************************************************************************************
+// sleeping
+// ********************************************************************************************************************
+
+// most of the level is usually at rest, and testing entities that didn't move against each other finds the same contacts as last frame.
+// Touching entities form an island (union-find over the frame collisions), and an island where nobody moved for
+// `SLEEP_FRAMES` frames goes to sleep as a whole: no movement, no broadphase update (after a last one, see `entity_is_still()`), no narrowphase between sleeping entities.
+// Awake entities are still tested against sleeping ones, and touching one wakes up its whole island.
+// NOTE: statics don't join islands (otherwise everything touching the border would be a single island), and they never wake anybody up
+
+static inline Uint32 island_find(Uint32* parents, Uint32 idx)
+{
+	// path halving: every node we walk through skips its parent, so trees stay flat without a second pass
+	while(parents[idx] != idx)
+	{
+		parents[idx] = parents[parents[idx]];
+		idx = parents[idx];
+	}
+	return idx;
+}
+
+static inline void island_union(Uint32* parents, Uint32 idx_0, Uint32 idx_1)
+{
+	Uint32 root_0 = island_find(parents, idx_0);
+	Uint32 root_1 = island_find(parents, idx_1);
+	if(root_0 != root_1)
+		parents[SDL_max(root_0, root_1)] = SDL_min(root_0, root_1);
+}
+
+// wakes up the whole island of `entity` (if it's sleeping)
+static void sleep_wake(GameState* state, Entity* entity)
+{
+	if(!entity->is_sleeping)
+		return;
+
+	Entity* member = entity;
+	do
+	{
+		member->is_sleeping  = false;
+		member->is_waking    = true;
+		member->sleep_frames = 0;
+		member = &state->entities[member->island_next];
+		state->sleeping_count--;
+	} while(member != entity);
+}
+
+#ifndef COLLISIONS_HEADLESS
+static void sleep_wake_all(GameState* state)
+{
+	for(int i = 0; i < state->entities_alive_count; ++i)
+		sleep_wake(state, &state->entities[i]);
+}
+#endif
+
+// pairs with a sleeping entity are only tested when the other one is awake, so any contact with a sleeping entity wakes it up
+// NOTE: this must happen before anybody reacts to the contacts, so sleeping entities are never moved
+static void sleep_wake_touched(GameState* state)
+{
+	for(ContactBlock* block = state->frame_collisions.first; block; block = block->next)
+	{
+		for(int i = 0; i < block->count; ++i)
+		{
+			sleep_wake(state, block->contacts[i].e1);
+			sleep_wake(state, block->contacts[i].e2);
+		}
+	}
+}
+
+// builds the islands of awake entities from this frame's collisions, and puts to sleep the ones that stayed still long enough
+static void sleep_update(GameState* state)
+{
+	Uint32* parents = state->island_parents;
+
+	// 1. every awake entity is its own island
+	for(int i = 0; i < state->entities_alive_count; ++i)
+		parents[i] = (Uint32)i;
+
+	// 2. touching entities end up in the same island
+	for(ContactBlock* block = state->frame_collisions.first; block; block = block->next)
+	{
+		for(int i = 0; i < block->count; ++i)
+		{
+			EntityCollisionInfo* info = &block->contacts[i];
+			if(info->e2->collider_is_static)
+				continue;
+
+			island_union(parents, (Uint32)(info->e1 - state->entities), (Uint32)(info->e2 - state->entities));
+		}
+	}
+
+	// 3. an island can't sleep if any of its entities moved during the last `SLEEP_FRAMES` frames
+	for(int i = 0; i < state->entities_alive_count; ++i)
+	{
+		state->island_can_sleep[i] = true;
+		state->island_heads[i]     = WORLD_PARTITION_INVALID_IDX;
+	}
+	for(int i = 0; i < state->entities_alive_count; ++i)
+	{
+		Entity* entity = &state->entities[i];
+		if(entity->collider_is_static || entity->is_sleeping)
+			continue;
+
+		entity->is_waking = false;
+		if(distance_sq(entity->position, entity->sleep_position) < SLEEP_DISTANCE * SLEEP_DISTANCE)
+			entity->sleep_frames++;
+		else
+			entity->sleep_frames = 0;
+		entity->sleep_position = entity->position;
+
+		if(entity->sleep_frames < SLEEP_FRAMES || !DEBUG_sleeping)
+			state->island_can_sleep[island_find(parents, i)] = false;
+	}
+
+	// 4. put whole islands to sleep, chaining their entities so they can be woken up together
+	state->islands_count = 0;
+	for(int i = 0; i < state->entities_alive_count; ++i)
+	{
+		Entity* entity = &state->entities[i];
+		if(entity->collider_is_static || entity->is_sleeping)
+			continue;
+
+		Uint32 root = island_find(parents, i);
+		if(root == (Uint32)i)
+			state->islands_count++;
+		if(!state->island_can_sleep[root])
+			continue;
+
+		Uint32 head = state->island_heads[root];
+		if(head == WORLD_PARTITION_INVALID_IDX)
+		{
+			state->island_heads[root] = i;
+			entity->island_next = i;
+		}
+		else
+		{
+			entity->island_next = state->entities[head].island_next;
+			state->entities[head].island_next = i;
+		}
+		entity->is_sleeping = true;
+		entity->is_dozing   = true;
+		state->sleeping_count++;
+		state->dozing_count++;
+	}
+}
+
+#ifndef COLLISIONS_HEADLESS
+// runs build + check on the current entities for a range of world partition sizes and logs the average timings
+// (and the same for the other broadphases, as a comparison)
+// NOTE: entities are not moved or separated between iterations, so every run sees exactly the same data
+static void world_partition_benchmark(GameState* state)
+{
+	const int splits_to_test[] = { 1, 2, 4, 8, 16, 32 };
+	const int iterations = 32;
+
+	BroadphaseType broadphase_prev = state->broadphase;
+	int splits_prev = state->world_partition.splits;
+	float ticks_to_ms = 1000.0f / (float)SDL_GetPerformanceFrequency();
+
+	SDL_Log(
+		"[BENCHMARK] world partition (%s), %d entities, %d threads, %d iterations",
+		state->world_partition.incremental ? "incremental" : "counting sort", state->entities_alive_count, state->jobs.workers_active + 1, iterations
+	);
+	SDL_Log("[BENCHMARK]  cells    refs   build ms/f   check ms/f   collisions");
+	state->broadphase = BROADPHASE_TYPE_WORLD_PARTITION;
+	for(int i = 0; i < (int)array_size(splits_to_test); ++i)
+	{
+		world_partition_set_splits(&state->world_partition, splits_to_test[i]);
+
+		Uint64 ticks_build = 0;
+		Uint64 ticks_check = 0;
+		for(int it = 0; it < iterations; ++it)
+		{
+			Uint64 t0 = SDL_GetPerformanceCounter();
+			world_partition_reset(state);
+			Uint64 t1 = SDL_GetPerformanceCounter();
+			collision_check(state);
+			Uint64 t2 = SDL_GetPerformanceCounter();
+
+			ticks_build += t1 - t0;
+			ticks_check += t2 - t1;
+		}
+
+		SDL_Log(
+			"[BENCHMARK] %6d  %6d   %10.4f   %10.4f   %10d",
+			state->world_partition.cells_count,
+			world_partition_get_refs_count(&state->world_partition),
+			ticks_build * ticks_to_ms / iterations,
+			ticks_check * ticks_to_ms / iterations,
+			state->frame_collisions.count
+		);
+	}
+
+	world_partition_set_splits(&state->world_partition, splits_prev);
+	world_partition_reset(state);
+
+	// other broadphases: "build" is the per-frame update on data that didn't move, which is the common case between frames
+	for(int type = BROADPHASE_TYPE_SWEEP_AND_PRUNE; type < BROADPHASE_TYPE_MAX; ++type)
+	{
+		state->broadphase = (BroadphaseType)type;
+		broadphase_reset(state);
+
+		Uint64 ticks_build = 0;
+		Uint64 ticks_check = 0;
+		for(int it = 0; it < iterations; ++it)
+		{
+			Uint64 t0 = SDL_GetPerformanceCounter();
+			broadphase_update(state);
+			Uint64 t1 = SDL_GetPerformanceCounter();
+			collision_check(state);
+			Uint64 t2 = SDL_GetPerformanceCounter();
+
+			ticks_build += t1 - t0;
+			ticks_check += t2 - t1;
+		}
+
+		SDL_Log(
+			"[BENCHMARK]   %s          %10.4f   %10.4f   %10d",
+			BROADPHASE_TYPE_NAMES[type],
+			ticks_build * ticks_to_ms / iterations,
+			ticks_check * ticks_to_ms / iterations,
+			state->frame_collisions.count
+		);
+	}
+
+	state->broadphase = broadphase_prev;
+	broadphase_reset(state);
+}
+#endif
+
+// ********************************************************************************************************************
+// game
+// ********************************************************************************************************************
+
+static void game_init(SDLContext* context, GameState* state)
+{
+	state->entities = (Entity*)SDL_calloc(ENTITY_COUNT, sizeof(Entity));
+	SDL_assert(state->entities);
+
+	itu_lib_arena_init(&state->frame_arena, FRAME_ARENA_CHUNK_SIZE);
+	itu_lib_pairs_init(&state->collision_pairs, sizeof(CollisionPair), ENTITY_COUNT * 4);
+
+	// narrowphase jobs (the main thread works too, so one worker less than the available cores)
+	itu_lib_jobs_init(&state->jobs, SDL_GetNumLogicalCPUCores() - 1);
+	state->collision_jobs = (CollisionJob*)SDL_calloc(COLLISION_JOBS_MAX, sizeof(CollisionJob));
+	SDL_assert(state->collision_jobs);
+
+	// world partitioning data allocation
+	{
+		WorldPartition* partition = &state->world_partition;
+
+		// we will split out game world in WORLD_PARTITION_CELL_SPLITS vertically and WORLD_PARTITION_CELL_SPLITS horizontally
+		world_partition_set_splits(partition, WORLD_PARTITION_CELL_SPLITS);
+
+		partition->entity_ranges = (WorldPartitionRange*)SDL_calloc(ENTITY_COUNT, sizeof(WorldPartitionRange));
+		SDL_assert(partition->entity_ranges);
+
+		// incremental mode data (cells are allocated with the splits, links are allocated on demand)
+		partition->entity_memberships = (Uint32*)SDL_calloc(ENTITY_COUNT, sizeof(Uint32));
+		SDL_assert(partition->entity_memberships);
+		partition->memberships_free = WORLD_PARTITION_INVALID_IDX;
+
+		// a small entity overlaps at most 4 cells, this is a reasonable starting point (`world_partition_build()` will grow it if needed)
+		partition->entity_idxs_capacity = ENTITY_COUNT * 4;
+		partition->entity_idxs = (Uint32*)SDL_calloc(partition->entity_idxs_capacity, sizeof(Uint32));
+		SDL_assert(partition->entity_idxs);
+	}
+
+	// sweep and prune data allocation
+	{
+		SweepAndPrune* sap = &state->sweep_and_prune;
+		sap->endpoints    = (SweepAndPruneEndpoint*)SDL_calloc(ENTITY_COUNT * 2, sizeof(SweepAndPruneEndpoint));
+		sap->active       = (Uint32*)SDL_calloc(ENTITY_COUNT, sizeof(Uint32));
+		sap->active_slots = (Uint32*)SDL_calloc(ENTITY_COUNT, sizeof(Uint32));
+		SDL_assert(sap->endpoints && sap->active && sap->active_slots);
+	}
+
+	// static grid data allocation (any entity can be static, so we size it for all of them)
+	{
+		StaticGrid* grid = &state->static_grid;
+		grid->splits      = STATIC_GRID_SPLITS;
+		grid->cell_size.x = WINDOW_W / (float)grid->splits;
+		grid->cell_size.y = WINDOW_H / (float)grid->splits;
+		grid->cell_start  = (int*)   SDL_calloc(grid->splits * grid->splits + 1, sizeof(int));
+		grid->cell_cursor = (int*)   SDL_calloc(grid->splits * grid->splits + 1, sizeof(int));
+		grid->entity_idxs = (Uint32*)SDL_calloc(ENTITY_COUNT, sizeof(Uint32));
+		grid->x           = (float*) SDL_calloc(ENTITY_COUNT, sizeof(float));
+		grid->y           = (float*) SDL_calloc(ENTITY_COUNT, sizeof(float));
+		grid->radius      = (float*) SDL_calloc(ENTITY_COUNT, sizeof(float));
+		grid->hits        = (int*)   SDL_calloc(ENTITY_COUNT, sizeof(int));
+		SDL_assert(grid->cell_start && grid->cell_cursor && grid->entity_idxs && grid->x && grid->y && grid->radius && grid->hits);
+	}
+
+	// bvh data allocation
+	{
+		// NOTE: a tree with N leaves has N-1 internal nodes
+		itu_lib_bvh_init(&state->bvh, BVH_MARGIN, ENTITY_COUNT * 2);
+		state->bvh_leaves = (int*)SDL_calloc(ENTITY_COUNT, sizeof(int));
+		SDL_assert(state->bvh_leaves);
+	}
+
+	// islands data allocation
+	{
+		state->island_parents   = (Uint32*)SDL_calloc(ENTITY_COUNT, sizeof(Uint32));
+		state->island_heads     = (Uint32*)SDL_calloc(ENTITY_COUNT, sizeof(Uint32));
+		state->island_can_sleep = (bool*)  SDL_calloc(ENTITY_COUNT, sizeof(bool));
+		SDL_assert(state->island_parents && state->island_heads && state->island_can_sleep);
+	}
+
+	// separation solver data allocation
+	{
+		state->separation_entity_colors = (Uint64*)SDL_calloc(ENTITY_COUNT, sizeof(Uint64));
+		SDL_assert(state->separation_entity_colors);
+		state->separation_iterations = SEPARATION_ITERATIONS;
+	}
+
+	// texture atlases
+#ifndef COLLISIONS_HEADLESS
+	state->atlas = texture_create(context, "../data/kenney/simpleSpace_tilesheet_2.png");
+#endif
+
+}
+
+// NOTE: the headless benchmark includes this file and brings its own game loop (and `main()`)
+#ifndef COLLISIONS_HEADLESS
+static void game_reset(SDLContext* context, GameState* state)
+{
+	// entities
 	{
 		SDL_memset(state->entities, 0, ENTITY_COUNT * sizeof(Entity));
 		state->entities_alive_count = 0;
@@ -488,10 +2144,10 @@ static void game_reset(SDLContext* context, GameState* state)
 		// grid pattern
 		const float scale_size = 0.2f; // factor to tune all entity size, to test world partitioning easier
 
-		int grid_side = (int)SDL_sqrt(ENTITY_COUNT);
+		int grid_side = (int)SDL_sqrt(ENTITY_DYNAMIC_COUNT);
 		int grid_side_half = grid_side / 2;
 		float separation_factor = 1.1f;
-		for(int i = 0; i < ENTITY_COUNT; ++i)
+		for(int i = 0; i < ENTITY_DYNAMIC_COUNT; ++i)
 		{
 			Entity* entity = entity_create(state);
 			if(!entity)
@@ -515,29 +2171,60 @@ static void game_reset(SDLContext* context, GameState* state)
 			};
 			entity->collider_is_static = false;
 			entity->collider_radius = 18 * scale_size;
+
+			// some ghosts mixed in, they pass through everything but walls
+			bool is_ghost = i % 8 == 0;
+			entity->collider_layer = is_ghost ? COLLISION_LAYER_GHOST : COLLISION_LAYER_DEFAULT;
+			entity->collider_mask  = is_ghost ? COLLISION_LAYER_WALL  : COLLISION_MASK_ALL;
 		}
-	}
 
-	// world partition
-	if(WORLD_PARTITION_CELL_SPLITS > 0)
-	{
-		state->world_partition_cell_size.x = WINDOW_W / WORLD_PARTITION_CELL_SPLITS;
-		state->world_partition_cell_size.y = WINDOW_H / WORLD_PARTITION_CELL_SPLITS;
-		// initialize cells
-		for(int i = 0; i < state->world_partition_cells_count; ++i)
+		// static border around the window, so dynamic entities have something to bump into
+		vec2f border_min  = vec2f{ 16, 16 };
+		vec2f border_size = vec2f{ WINDOW_W, WINDOW_H } - border_min * 2;
+		float perimeter   = (border_size.x + border_size.y) * 2;
+		for(int i = 0; i < ENTITY_STATIC_COUNT; ++i)
 		{
-			int cell_coord_x = i % WORLD_PARTITION_CELL_SPLITS;
-			int cell_coord_y = i / WORLD_PARTITION_CELL_SPLITS;
-
-			WorldPartitionCell* cell = &state->world_partition_cells[i];
-			cell->entity_refs_counts = 0;
-			cell->min.x = cell_coord_x * state->world_partition_cell_size.x;
-			cell->min.y = cell_coord_y * state->world_partition_cell_size.y;
-			cell->max.x = (cell_coord_x + 1) * state->world_partition_cell_size.x;
-			cell->max.y = (cell_coord_y + 1) * state->world_partition_cell_size.y;
+			Entity* entity = entity_create(state);
+			if(!entity)
+				break;
+
+			// walk the border clockwise, starting from the top-left corner
+			float d = perimeter * i / ENTITY_STATIC_COUNT;
+			vec2f p;
+			if(d < border_size.x)                                  p = vec2f{ d, 0 };
+			else if((d -= border_size.x) < border_size.y)          p = vec2f{ border_size.x, d };
+			else if((d -= border_size.y) < border_size.x)          p = vec2f{ border_size.x - d, border_size.y };
+			else                                                   p = vec2f{ 0, border_size.y - (d - border_size.x) };
+
+			entity->size = vec2f{ 64, 64 } *scale_size;
+			entity->position = border_min + p;
+			entity->sprite = Sprite
+			{
+				state->atlas,
+				SDL_FRect{ 0, 4*128, 128, 128 },
+				COLOR_WHITE,
+				vec2f{ 0.5f, 0.5f }
+			};
+			entity->collider_is_static = true;
+			entity->collider_radius = 18 * scale_size;
+			entity->collider_layer = COLLISION_LAYER_WALL;
+			entity->collider_mask  = COLLISION_MASK_ALL;
 		}
-		world_partition_assign_all_entitites(state);
 	}
+
+	// statics never move, this is the only place where they get binned
+	static_grid_build(state);
+
+	// entity indices are reused by the new entities, old pairs mean nothing now
+	itu_lib_pairs_clear(&state->collision_pairs);
+
+	// everybody starts awake
+	state->sleeping_count = 0;
+	state->dozing_count   = 0;
+	state->islands_count  = 0;
+
+	// broadphase
+	broadphase_reset(state);
 }
 
 static void game_update(SDLContext* context, GameState* state)
@@ -558,28 +2245,32 @@ static void game_update(SDLContext* context, GameState* state)
 	// state->player->position = state->player->position + velocity;
 
 	// // move all entities (to test world partition balancing)
-	for(int i = 0; i < state->entities_alive_count; ++i)
+	// NOTE: pushing an entity wakes it up (and its island with it), when nobody is pushed sleeping entities are not even looked at
+	if(mov.x != 0 || mov.y != 0)
 	{
-		Entity* entity = &state->entities[i];
-		entity->position = entity->position + velocity;
-	}
+		for(int i = 0; i < state->entities_alive_count; ++i)
+		{
+			Entity* entity = &state->entities[i];
+			if(entity->collider_is_static)
+				continue;
 
-	// reset tint
-	for(int i = 0; i < state->entities_alive_count; ++i)
-	{
-		Entity* entity = &state->entities[i];
-		entity->sprite.tint = COLOR_WHITE;
+			sleep_wake(state, entity);
+			entity->position = entity->position + velocity;
+		}
 	}
 
+	// NOTE: the broadphase has to see where entities are *now*, after they moved, or it misses the contacts they just made
+	//       (the endpoints of the sweep and prune have no margin at all, unlike the BVH leaves).
+	//       Re-assigning every entity EVERY frame is a waste if most of them stay in the same cells,
+	//       the incremental mode ([F8]) only moves entities that crossed a cell boundary
+	broadphase_update(state);
+
 	collision_check(state);
+	sleep_wake_touched(state);
+	collision_update_pairs(state);
 	if(DEBUG_separate_collisions)
 		collision_separate(state);
-
-	// NOTE: here is where we would like to "update" our cells, checking if any Entity moved in or out of a cell
-	//       However, pointers make it really annoying to handle two-way references this way.
-	//       Surely, re-assigning every entity EVERY frame is a waste? We will discuss this next lecture
-	if(state->world_partition_cells_count > 0)
-		world_partition_assign_all_entitites(state);
+	sleep_update(state);
 }
 
 static void game_render(SDLContext* context, GameState* state)
@@ -588,24 +2279,35 @@ static void game_render(SDLContext* context, GameState* state)
 	for(int i = 0; i < state->entities_alive_count; ++i)
 	{
 		Entity* entity = &state->entities[i];
+		entity->sprite.tint = entity->contacts_count > 0 ? COLOR_RED : COLOR_WHITE;
 		sprite_render(context, entity->position, entity->size, &entity->sprite);
 
 		if(DEBUG_render_colliders)
 		{
-			itu_lib_render_draw_point(context->renderer, entity->position + entity->collider_offset, 5, COLOR_GREEN);
+			color collider_color = entity->collider_is_static ? COLOR_BLUE : COLOR_GREEN;
+			if(entity->collider_layer == COLLISION_LAYER_GHOST)
+				collider_color = color{ 1.0f, 0.0f, 1.0f, 1.0f };
+			if(entity->is_sleeping)
+				collider_color.a = 0.3f;
+			itu_lib_render_draw_point(context->renderer, entity->position + entity->collider_offset, 5, collider_color);
 			itu_lib_render_draw_circle(
 				context->renderer,
 				entity->position + entity->collider_offset,
 				entity->collider_radius,
-				16, COLOR_GREEN
+				16, collider_color
 			);
 		}
 	}
 
-	// debug world partition
+	// debug broadphase
+	if(state->broadphase == BROADPHASE_TYPE_WORLD_PARTITION)
 	{
 		world_partition_debug_cells(context, state);
 	}
+	if(state->broadphase == BROADPHASE_TYPE_BVH && DEBUG_render_colliders)
+	{
+		bvh_debug_nodes(context, state);
+	}
 	// debug window
 	SDL_SetRenderDrawColor(context->renderer, 0xFF, 0x00, 0xFF, 0xff);
 	SDL_RenderRect(context->renderer, NULL);
@@ -685,6 +2387,42 @@ int main(void)
 							case SDLK_F2: DEBUG_render_colliders      = !DEBUG_render_colliders;      break;
 							case SDLK_F3: DEBUG_render_texture_border = !DEBUG_render_texture_border; break;
 							case SDLK_F4: DEBUG_render_texture        = !DEBUG_render_texture;        break;
+							case SDLK_F5: world_partition_benchmark(&state); break;
+							case SDLK_F6:
+							case SDLK_F7:
+							{
+								int splits = state.world_partition.splits;
+								splits = event.key.key == SDLK_F7 ? SDL_max(splits * 2, 1) : splits / 2;
+								world_partition_set_splits(&state.world_partition, splits);
+								world_partition_reset(&state);
+								break;
+							}
+							case SDLK_F8:
+								state.world_partition.incremental = !state.world_partition.incremental;
+								world_partition_reset(&state);
+								break;
+							case SDLK_F9:
+								state.broadphase = (BroadphaseType)((state.broadphase + 1) % BROADPHASE_TYPE_MAX);
+								broadphase_reset(&state);
+								break;
+							case SDLK_F10:
+							{
+								// 1, 2, 4, ... threads, up to all of them (including the main thread)
+								int threads = state.jobs.workers_active + 1;
+								int threads_max = state.jobs.workers_count + 1;
+								threads = threads >= threads_max ? 1 : SDL_min(threads * 2, threads_max);
+								state.jobs.workers_active = threads - 1;
+								break;
+							}
+							case SDLK_F12:
+								// 1, 2, 4, 8 iterations
+								state.separation_iterations = state.separation_iterations >= 8 ? 1 : state.separation_iterations * 2;
+								break;
+							case SDLK_F11:
+								DEBUG_sleeping = !DEBUG_sleeping;
+								if(!DEBUG_sleeping)
+									sleep_wake_all(&state);
+								break;
 						}
 					}
 					break;
@@ -710,10 +2448,10 @@ int main(void)
 #ifdef ENABLE_DIAGNOSTICS
 		{
 			SDL_SetRenderDrawColor(context.renderer, 0x0, 0x00, 0x00, 0xCC);
-			SDL_FRect rect = SDL_FRect{ 5, 5, 225, 85 };
+			SDL_FRect rect = SDL_FRect{ 5, 5, 225, 215 };
 			SDL_RenderFillRect(context.renderer, &rect);
 			SDL_SetRenderDrawColor(context.renderer, 0xFF, 0xFF, 0xFF, 0xFF);
-			SDL_RenderDebugTextFormat(context.renderer, 10, 10, "entities : %d", ENTITY_COUNT);
+			SDL_RenderDebugTextFormat(context.renderer, 10, 10, "entities : %d (%d static)", state.entities_alive_count, state.static_grid.count);
 			SDL_RenderDebugTextFormat(context.renderer, 10, 20, "work     : %9.6f ms/f", (float)elapsed_work  / (float)MILLIS(1));
 			SDL_RenderDebugTextFormat(context.renderer, 10, 30, "tot      : %9.6f ms/f", (float)elapsed_frame / (float)MILLIS(1));
 			SDL_RenderDebugTextFormat(context.renderer, 10, 40, "[TAB] reset ");
@@ -721,6 +2459,19 @@ int main(void)
 			SDL_RenderDebugTextFormat(context.renderer, 10, 60, "[F2]  render colliders  %s", DEBUG_render_colliders      ? " ON" : "OFF");
 			SDL_RenderDebugTextFormat(context.renderer, 10, 70, "[F3]  render tex border %s", DEBUG_render_texture_border ? " ON" : "OFF");
 			SDL_RenderDebugTextFormat(context.renderer, 10, 80, "[F4]  render textures   %s", DEBUG_render_texture        ? " ON" : "OFF");
+			SDL_RenderDebugTextFormat(context.renderer, 10, 90, "[F5]  benchmark (log)");
+			SDL_RenderDebugTextFormat(context.renderer, 10,100, "[F6/F7] cells          %4d", state.world_partition.cells_count);
+			SDL_RenderDebugTextFormat(context.renderer, 10,110, "[F8]  incremental cells %s", state.world_partition.incremental ? " ON" : "OFF");
+			SDL_RenderDebugTextFormat(context.renderer, 10,120, "[F9]  broadphase       %s", BROADPHASE_TYPE_NAMES[state.broadphase]);
+			SDL_RenderDebugTextFormat(context.renderer, 10,130, "[F10] threads        %2d/%2d", state.jobs.workers_active + 1, state.jobs.workers_count + 1);
+			SDL_RenderDebugTextFormat(context.renderer, 10,140, "[F11] sleeping          %s", DEBUG_sleeping ? " ON" : "OFF");
+			SDL_RenderDebugTextFormat(context.renderer, 10,150, "[F12] separation iters  %d", state.separation_iterations);
+			SDL_RenderDebugTextFormat(context.renderer, 10,160, "collisions : %d (SAP swaps %d)", state.frame_collisions.count, state.sweep_and_prune.swaps_count);
+			SDL_RenderDebugTextFormat(context.renderer, 10,170, "BVH height : %d (reinserts %d)", itu_lib_bvh_get_height(&state.bvh), state.bvh_reinserts_count);
+			SDL_RenderDebugTextFormat(context.renderer, 10,180, "pairs : %d (+%d -%d)", state.collision_pairs.count, state.collision_pairs.began.count, state.collision_pairs.ended.count);
+			SDL_RenderDebugTextFormat(context.renderer, 10,190, "arena : %d/%d KB (max %d)", (int)(state.frame_arena.used / 1000), (int)(state.frame_arena.capacity / 1000), (int)(state.frame_arena.used_max / 1000));
+			SDL_RenderDebugTextFormat(context.renderer, 10,200, "sleeping : %d (%d islands awake)", state.sleeping_count, state.islands_count);
+			SDL_RenderDebugTextFormat(context.renderer, 10,210, "separation : %d colors (%d overflow)", state.separation_colors_count, state.separation_overflow_count);
 		}
 #endif
 
@@ -732,3 +2483,4 @@ int main(void)
 		walltime_frame_beg = walltime_frame_end;
 	}
 }
+#endif // COLLISIONS_HEADLESS
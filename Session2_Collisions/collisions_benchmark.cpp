@@ -0,0 +1,362 @@
+// headless benchmark of the collision pipeline in collisions.cpp (no window, no rendering, no video subsystem at all)
+//
+// runs every scenario of the sweep below for a fixed number of frames, timing each phase of the frame separately:
+// - check    : `collision_check()` (narrowphase of the active broadphase, plus statics) and `sleep_wake_touched()`
+// - pairs    : `collision_update_pairs()`
+// - separate : `collision_separate()`
+// - update   : `broadphase_update()` (before the check) and `sleep_update()`
+// and writes median and 99th percentile (in ms) of every phase to a CSV file, one row per scenario.
+// Every `BENCHMARK_BRUTE_FORCE_EVERY` frames the pairs found are also checked against a brute force O(N^2) test
+// (outside of the timings), and the pairs the broadphase missed go in the `missed` column, which should always be 0
+//
+// usage: collisions_benchmark [output.csv]   (default: collisions_benchmark.csv)
+//
+// NOTE: entities move with a fixed random velocity and bounce on the window borders, with a fixed seed,
+//       so every run (and every machine) sees exactly the same frames
+// NOTE: only `moving_ratio` of the dynamic entities get a velocity, the others are left alone and fall asleep once they settle
+
+#define COLLISIONS_HEADLESS
+
+// room for the biggest scenario
+#define ENTITY_DYNAMIC_COUNT 8192
+#define ENTITY_STATIC_COUNT  8192
+
+#include "collisions.cpp"
+
+#define BENCHMARK_FRAMES_WARMUP (SLEEP_FRAMES * 2) // long enough for resting islands to fall asleep
+#define BENCHMARK_FRAMES        128
+#define BENCHMARK_SEED          0x1234567
+
+#define BENCHMARK_BRUTE_FORCE_EVERY     64    // recorded frames between two brute force checks
+#define BENCHMARK_BRUTE_FORCE_TOLERANCE 0.01f // pixels, whether pairs touching less than this overlap is down to rounding
+
+#define BENCHMARK_CLUSTERS        8
+#define BENCHMARK_CLUSTER_RADIUS  100.0f
+#define BENCHMARK_SPEED_MAX       60.0f  // pixels per second
+
+enum BenchmarkDistribution
+{
+	BENCHMARK_DISTRIBUTION_GRID,      // evenly spread over the whole window
+	BENCHMARK_DISTRIBUTION_CLUSTERED, // a few dense blobs, most of the window is empty
+
+	BENCHMARK_DISTRIBUTION_MAX
+};
+
+const char* BENCHMARK_DISTRIBUTION_NAMES[BENCHMARK_DISTRIBUTION_MAX] = { "grid", "clustered" };
+
+enum BenchmarkPhase
+{
+	BENCHMARK_PHASE_CHECK,
+	BENCHMARK_PHASE_PAIRS,
+	BENCHMARK_PHASE_SEPARATE,
+	BENCHMARK_PHASE_UPDATE,
+	BENCHMARK_PHASE_TOTAL,
+
+	BENCHMARK_PHASE_MAX
+};
+
+const char* BENCHMARK_PHASE_NAMES[BENCHMARK_PHASE_MAX] = { "check", "pairs", "separate", "update", "total" };
+
+struct BenchmarkScenario
+{
+	BroadphaseType        broadphase;
+	int                   splits;       // only for the world partition
+	int                   entities_count;
+	float                 static_ratio;
+	float                 moving_ratio; // of the dynamic entities
+	BenchmarkDistribution distribution;
+};
+
+struct Benchmark
+{
+	vec2f* velocities; // one per entity, statics have none
+	Uint64 rng;
+
+	// one entry per recorded frame and phase
+	Uint64 ticks[BENCHMARK_PHASE_MAX][BENCHMARK_FRAMES];
+	Uint64 collisions_total;
+	Uint64 sleeping_total;
+	int    missed_total;     // overlapping pairs the broadphase didn't report, during the brute force checks
+};
+
+static vec2f benchmark_position(Benchmark* benchmark, BenchmarkDistribution distribution, int idx, int count, vec2f* cluster_centers)
+{
+	switch(distribution)
+	{
+		case BENCHMARK_DISTRIBUTION_GRID:
+		{
+			int side = (int)SDL_ceil(SDL_sqrt((double)count));
+			vec2f spacing = vec2f{ WINDOW_W / (float)side, WINDOW_H / (float)side };
+			return vec2f{ ((idx % side) + 0.5f) * spacing.x, ((idx / side) + 0.5f) * spacing.y };
+		}
+		case BENCHMARK_DISTRIBUTION_CLUSTERED:
+		{
+			// NOTE: uniform angle and distance, so entities are denser towards the center of the cluster
+			float angle    = SDL_randf_r(&benchmark->rng) * TAU;
+			float distance = SDL_randf_r(&benchmark->rng) * BENCHMARK_CLUSTER_RADIUS;
+			return cluster_centers[idx % BENCHMARK_CLUSTERS] + vec2f{ SDL_cosf(angle), SDL_sinf(angle) } * distance;
+		}
+		default: SDL_assert(false);
+	}
+	return VEC2F_ZERO;
+}
+
+// replaces all entities with the ones of the scenario, and rebuilds everything that depends on them
+static void benchmark_spawn(GameState* state, Benchmark* benchmark, BenchmarkScenario* scenario)
+{
+	SDL_memset(state->entities, 0, ENTITY_COUNT * sizeof(Entity));
+	state->entities_alive_count = 0;
+	state->sleeping_count       = 0;
+	state->dozing_count         = 0;
+	itu_lib_pairs_clear(&state->collision_pairs);
+
+	benchmark->rng = BENCHMARK_SEED;
+
+	vec2f cluster_centers[BENCHMARK_CLUSTERS];
+	for(int i = 0; i < BENCHMARK_CLUSTERS; ++i)
+	{
+		cluster_centers[i].x = BENCHMARK_CLUSTER_RADIUS + SDL_randf_r(&benchmark->rng) * (WINDOW_W - BENCHMARK_CLUSTER_RADIUS * 2);
+		cluster_centers[i].y = BENCHMARK_CLUSTER_RADIUS + SDL_randf_r(&benchmark->rng) * (WINDOW_H - BENCHMARK_CLUSTER_RADIUS * 2);
+	}
+
+	// statics are spread evenly among the entities (not all at the beginning), so they follow the same distribution
+	int count         = scenario->entities_count;
+	int statics_count = (int)(count * scenario->static_ratio);
+	int dynamic_idx   = 0;
+	for(int i = 0; i < count; ++i)
+	{
+		Entity* entity = entity_create(state);
+		SDL_assert(entity);
+
+		bool is_static = (i + 1) * statics_count / count != i * statics_count / count;
+
+		const float scale_size = 0.2f; // same as `game_reset()`
+		entity->size               = vec2f{ 64, 64 } * scale_size;
+		entity->position           = benchmark_position(benchmark, scenario->distribution, i, count, cluster_centers);
+		entity->collider_is_static = is_static;
+		entity->collider_radius    = 18 * scale_size;
+		entity->collider_layer     = is_static ? COLLISION_LAYER_WALL : COLLISION_LAYER_DEFAULT;
+		entity->collider_mask      = COLLISION_MASK_ALL;
+
+		// movers are spread evenly among the dynamic entities, same as statics
+		bool is_moving = false;
+		if(!is_static)
+		{
+			int dynamics_count = count - statics_count;
+			int movers_count   = (int)(dynamics_count * scenario->moving_ratio);
+			is_moving = (dynamic_idx + 1) * movers_count / dynamics_count != dynamic_idx * movers_count / dynamics_count;
+			dynamic_idx++;
+		}
+
+		float angle = SDL_randf_r(&benchmark->rng) * TAU;
+		float speed = SDL_randf_r(&benchmark->rng) * BENCHMARK_SPEED_MAX;
+		benchmark->velocities[i] = is_moving ? vec2f{ SDL_cosf(angle), SDL_sinf(angle) } * speed : VEC2F_ZERO;
+	}
+
+	static_grid_build(state);
+
+	state->broadphase = scenario->broadphase;
+	if(scenario->broadphase == BROADPHASE_TYPE_WORLD_PARTITION)
+		world_partition_set_splits(&state->world_partition, scenario->splits);
+	broadphase_reset(state);
+}
+
+static void benchmark_move(GameState* state, Benchmark* benchmark, float delta)
+{
+	for(int i = 0; i < state->entities_alive_count; ++i)
+	{
+		Entity* entity = &state->entities[i];
+		vec2f* velocity = &benchmark->velocities[i];
+		if(entity->collider_is_static || (velocity->x == 0 && velocity->y == 0))
+			continue;
+
+		// same as the player pushing entities in `game_update()`
+		sleep_wake(state, entity);
+		entity->position += *velocity * delta;
+
+		// bounce, so nothing leaves the window and the density stays the same during the whole run
+		if((entity->position.x < 0 && velocity->x < 0) || (entity->position.x > WINDOW_W && velocity->x > 0))
+			velocity->x = -velocity->x;
+		if((entity->position.y < 0 && velocity->y < 0) || (entity->position.y > WINDOW_H && velocity->y > 0))
+			velocity->y = -velocity->y;
+	}
+}
+
+// tests every pair against every other, and counts the overlapping ones that are not in `GameState::collision_pairs`
+// (the ones the broadphase missed). Sleeping pairs that were not tested this frame are in the table too (see `collision_pair_keep()`)
+// NOTE: must run after `collision_update_pairs()` and before anything moves again
+static int benchmark_check_brute_force(GameState* state)
+{
+	int ret = 0;
+	for(int i = 0; i < state->entities_alive_count; ++i)
+	{
+		for(int j = i + 1; j < state->entities_alive_count; ++j)
+		{
+			Entity* e1 = &state->entities[i];
+			Entity* e2 = &state->entities[j];
+			if((e1->collider_is_static && e2->collider_is_static) || !collision_layers_match(e1, e2))
+				continue;
+
+			EntityCollisionInfo info;
+			if(!collision_test_pair(e1, e2, &info) || info.separation < BENCHMARK_BRUTE_FORCE_TOLERANCE)
+				continue;
+
+			if(!itu_lib_pairs_find(&state->collision_pairs, (Uint32)i, (Uint32)j))
+				ret++;
+		}
+	}
+	return ret;
+}
+
+// same order of `game_update()`, with a timestamp between phases
+static void benchmark_frame(GameState* state, Benchmark* benchmark, int frame_idx)
+{
+	benchmark_move(state, benchmark, 1.0f / 60.0f);
+
+	Uint64 t0 = SDL_GetPerformanceCounter();
+	broadphase_update(state);
+	Uint64 t1 = SDL_GetPerformanceCounter();
+	collision_check(state);
+	sleep_wake_touched(state);
+	Uint64 t2 = SDL_GetPerformanceCounter();
+	collision_update_pairs(state);
+	Uint64 t3 = SDL_GetPerformanceCounter();
+
+	// NOTE: not timed, it's way slower than everything else put together
+	if(frame_idx >= 0 && frame_idx % BENCHMARK_BRUTE_FORCE_EVERY == 0)
+		benchmark->missed_total += benchmark_check_brute_force(state);
+
+	Uint64 t4 = SDL_GetPerformanceCounter();
+	collision_separate(state);
+	Uint64 t5 = SDL_GetPerformanceCounter();
+	sleep_update(state);
+	Uint64 t6 = SDL_GetPerformanceCounter();
+
+	if(frame_idx < 0)
+		return;
+
+	benchmark->ticks[BENCHMARK_PHASE_CHECK   ][frame_idx] = t2 - t1;
+	benchmark->ticks[BENCHMARK_PHASE_PAIRS   ][frame_idx] = t3 - t2;
+	benchmark->ticks[BENCHMARK_PHASE_SEPARATE][frame_idx] = t5 - t4;
+	benchmark->ticks[BENCHMARK_PHASE_UPDATE  ][frame_idx] = (t1 - t0) + (t6 - t5);
+	benchmark->ticks[BENCHMARK_PHASE_TOTAL   ][frame_idx] = (t3 - t0) + (t6 - t4);
+	benchmark->collisions_total += state->frame_collisions.count;
+	benchmark->sleeping_total   += state->sleeping_count;
+}
+
+static int benchmark_ticks_compare(const void* a, const void* b)
+{
+	Uint64 ticks_a = *(const Uint64*)a;
+	Uint64 ticks_b = *(const Uint64*)b;
+	return ticks_a < ticks_b ? -1 : ticks_a > ticks_b ? 1 : 0;
+}
+
+// NOTE: sorts `ticks` in place
+static float benchmark_percentile_ms(Uint64* ticks, int count, float percentile)
+{
+	SDL_qsort(ticks, count, sizeof(Uint64), benchmark_ticks_compare);
+	int idx = SDL_clamp((int)(percentile * (count - 1) + 0.5f), 0, count - 1);
+	return ticks[idx] * 1000.0f / (float)SDL_GetPerformanceFrequency();
+}
+
+static void benchmark_run(GameState* state, Benchmark* benchmark, BenchmarkScenario* scenario, SDL_IOStream* csv)
+{
+	benchmark_spawn(state, benchmark, scenario);
+
+	benchmark->collisions_total = 0;
+	benchmark->sleeping_total   = 0;
+	benchmark->missed_total     = 0;
+	for(int i = -BENCHMARK_FRAMES_WARMUP; i < BENCHMARK_FRAMES; ++i)
+		benchmark_frame(state, benchmark, i);
+
+	const char* broadphase_name = scenario->broadphase == BROADPHASE_TYPE_WORLD_PARTITION ? "grid"
+	                            : scenario->broadphase == BROADPHASE_TYPE_SWEEP_AND_PRUNE ? "sap"
+	                            : "bvh";
+	SDL_IOprintf(
+		csv, "%s,%d,%d,%.3f,%.3f,%s,%d,%d,%d,%d",
+		broadphase_name, scenario->splits, scenario->entities_count, scenario->static_ratio, scenario->moving_ratio,
+		BENCHMARK_DISTRIBUTION_NAMES[scenario->distribution],
+		state->jobs.workers_active + 1, (int)(benchmark->collisions_total / BENCHMARK_FRAMES), (int)(benchmark->sleeping_total / BENCHMARK_FRAMES),
+		benchmark->missed_total
+	);
+
+	float total_median = 0;
+	for(int phase = 0; phase < BENCHMARK_PHASE_MAX; ++phase)
+	{
+		float median = benchmark_percentile_ms(benchmark->ticks[phase], BENCHMARK_FRAMES, 0.50f);
+		float p99    = benchmark_percentile_ms(benchmark->ticks[phase], BENCHMARK_FRAMES, 0.99f);
+		SDL_IOprintf(csv, ",%.4f,%.4f", median, p99);
+		if(phase == BENCHMARK_PHASE_TOTAL)
+			total_median = median;
+	}
+	SDL_IOprintf(csv, "\n");
+
+	if(benchmark->missed_total > 0)
+		SDL_Log("[BENCHMARK] ERROR %s: missed %d overlapping pairs", broadphase_name, benchmark->missed_total);
+
+	SDL_Log(
+		"[BENCHMARK] %s %3d splits, %5d entities (%3d%% static, %3d%% moving), %-9s: %8.4f ms/f",
+		broadphase_name, scenario->splits, scenario->entities_count, (int)(scenario->static_ratio * 100), (int)(scenario->moving_ratio * 100),
+		BENCHMARK_DISTRIBUTION_NAMES[scenario->distribution], total_median
+	);
+}
+
+int main(int argc, char** argv)
+{
+	const char* csv_path = argc > 1 ? argv[1] : "collisions_benchmark.csv";
+
+	const int   entities_counts[] = { 1024, 2048, 4096, 8192 };
+	const float static_ratios[]   = { 0.0f, 0.5f, 0.875f };
+	const float moving_ratios[]   = { 1.0f, 0.125f };
+	const int   splits_to_test[]  = { 4, 8, 16, 32, 64 };
+
+	SDL_IOStream* csv = SDL_IOFromFile(csv_path, "w");
+	VALIDATE_PANIC(csv);
+
+	// NOTE: game_init() only needs a renderer for the textures, which are skipped in headless mode
+	SDLContext context = { 0 };
+	static GameState state = { 0 };
+	game_init(&context, &state);
+	DEBUG_separate_collisions = true;
+
+	static Benchmark benchmark = { 0 };
+	benchmark.velocities = (vec2f*)SDL_calloc(ENTITY_COUNT, sizeof(vec2f));
+	SDL_assert(benchmark.velocities);
+
+	SDL_IOprintf(csv, "broadphase,splits,entities,static_ratio,moving_ratio,distribution,threads,collisions,sleeping,missed");
+	for(int phase = 0; phase < BENCHMARK_PHASE_MAX; ++phase)
+		SDL_IOprintf(csv, ",%s_median_ms,%s_p99_ms", BENCHMARK_PHASE_NAMES[phase], BENCHMARK_PHASE_NAMES[phase]);
+	SDL_IOprintf(csv, "\n");
+
+	for(int e = 0; e < (int)array_size(entities_counts); ++e)
+	for(int r = 0; r < (int)array_size(static_ratios); ++r)
+	for(int m = 0; m < (int)array_size(moving_ratios); ++m)
+	for(int d = 0; d < BENCHMARK_DISTRIBUTION_MAX; ++d)
+	{
+		BenchmarkScenario scenario;
+		scenario.entities_count = entities_counts[e];
+		scenario.static_ratio   = static_ratios[r];
+		scenario.moving_ratio   = moving_ratios[m];
+		scenario.distribution   = (BenchmarkDistribution)d;
+
+		SDL_assert(scenario.entities_count <= ENTITY_COUNT);
+
+		scenario.broadphase = BROADPHASE_TYPE_WORLD_PARTITION;
+		for(int s = 0; s < (int)array_size(splits_to_test); ++s)
+		{
+			scenario.splits = splits_to_test[s];
+			benchmark_run(&state, &benchmark, &scenario, csv);
+		}
+
+		scenario.splits = 0;
+		for(int type = BROADPHASE_TYPE_SWEEP_AND_PRUNE; type < BROADPHASE_TYPE_MAX; ++type)
+		{
+			scenario.broadphase = (BroadphaseType)type;
+			benchmark_run(&state, &benchmark, &scenario, csv);
+		}
+	}
+
+	SDL_CloseIO(csv);
+	SDL_Log("[BENCHMARK] results written to %s", csv_path);
+	return 0;
+}
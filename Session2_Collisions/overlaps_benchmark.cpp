@@ -0,0 +1,962 @@
+// microbenchmark of every `itu_lib_overlaps_*` test (no window, no rendering, no video subsystem at all)
+//
+// pair tests are timed over a fixed set of seeded random inputs, built so that we know exactly which ones overlap.
+// Every test runs on 4 mixes of the same inputs:
+// - miss   : no input overlaps
+// - hit    : every input overlaps
+// - sorted : half and half, all hits first (branches are easy to predict)
+// - random : same inputs as `sorted`, shuffled (branches are as hard to predict as they get)
+// so the cost of early outs (ie, the order of the tests in `circle_rect` or `segment_rect`) shows in hit vs miss,
+// and the cost of branch misses shows in random vs sorted.
+//
+// GJK is also timed on pairs that move a little every frame (like a resting pile), once from scratch ("cold") and once
+// warm-started from a `GJKCache` kept per pair in a `PairTable` ("warm"), the way a narrowphase would keep it across frames
+//
+// batch tests (`circle_circles` and `segment_circles`) are timed per circle, once per kernel available on this machine
+// (scalar, SSE2, AVX2, NEON, plus whatever the library picks by itself), against a loop of the single pair test
+//
+// results (ns per test, and millions of tests per second) are written to a CSV file, one row per test/kernel/mix
+//
+// usage: overlaps_benchmark [output.csv]   (default: overlaps_benchmark.csv)
+//
+// NOTE: inputs are small enough to stay in cache, so these are "hot" numbers: they tell how expensive the math is,
+//       not how expensive it is to bring the shapes in from memory (collisions_benchmark.cpp is better for that)
+// NOTE: the `itu_lib_collide_*` and `itu_lib_sweep_*` functions are not measured here. Before the timings though,
+//       EPA contacts are checked against SAT on random polygon pairs (see `benchmark_check_epa()`), and disagreements count as errors
+
+#define ITU_UNITY_BUILD
+
+#include <SDL3/SDL.h>
+
+#include <itu_common.hpp>
+#include <itu_lib_overlaps.hpp>
+#include <itu_lib_arena.hpp>
+#include <itu_lib_pairs.hpp>
+
+#define BENCHMARK_SEED            0x1234567
+#define BENCHMARK_INPUTS_COUNT    2048  // per mix. Enough that the branch predictor can't learn the whole random sequence
+#define BENCHMARK_REPEATS         7     // the median of these is reported
+#define BENCHMARK_REPEAT_MIN_NS   MILLIS(1)
+#define BENCHMARK_ATTEMPTS_MAX    100000
+#define BENCHMARK_VERTICES_MAX    32
+#define BENCHMARK_VERTICES_DEFAULT 8
+
+// shapes are placed in a 100x100 area, the second shape of each pair close to the first one
+// NOTE: sizes and spread are picked so both hits and (near) misses are common for every pair of shapes
+#define BENCHMARK_AREA        100.0f
+#define BENCHMARK_SPREAD      40.0f
+#define BENCHMARK_SIZE_MIN    10.0f
+#define BENCHMARK_SIZE_MAX    40.0f
+
+#define BENCHMARK_CIRCLES_COUNT 2048
+
+#define BENCHMARK_COHERENT_PAIRS_COUNT 1024
+#define BENCHMARK_COHERENT_FRAMES      64
+#define BENCHMARK_COHERENT_AMPLITUDE   0.5f  // how far shapes wander from where they started (shapes are 10 to 40 across)
+
+#define BENCHMARK_EPA_CHECKS_COUNT 10000
+#define BENCHMARK_EPA_TOLERANCE    0.01f // EPA stops within FLOAT_EPSILON of the border, the rest is rounding errors
+
+enum BenchmarkShapeType
+{
+	BENCHMARK_SHAPE_POINT,
+	BENCHMARK_SHAPE_SEGMENT,
+	BENCHMARK_SHAPE_CIRCLE,
+	BENCHMARK_SHAPE_RECT,
+	BENCHMARK_SHAPE_CAPSULE,
+	BENCHMARK_SHAPE_OBB,
+	BENCHMARK_SHAPE_POLYGON, // plain vertices, or `ConvexPolygon` (both are always filled)
+
+	BENCHMARK_SHAPE_MAX
+};
+
+enum BenchmarkMix
+{
+	BENCHMARK_MIX_MISS,
+	BENCHMARK_MIX_HIT,
+	BENCHMARK_MIX_SORTED,
+	BENCHMARK_MIX_RANDOM,
+
+	BENCHMARK_MIX_MAX
+};
+
+const char* BENCHMARK_MIX_NAMES[BENCHMARK_MIX_MAX] = { "miss", "hit", "sorted", "random" };
+
+// - point   : `a`
+// - segment : `a` to `b`
+// - circle  : center `a`, `radius`
+// - rect    : `a` (min) to `b` (max)
+// - capsule : `a` to `b`, `radius`
+// - obb     : `obb`
+// - polygon : `polygon` (plain polygon tests only use its vertices)
+struct BenchmarkShape
+{
+	vec2f a;
+	vec2f b;
+	float radius;
+	union
+	{
+		OBB           obb;
+		ConvexPolygon polygon;
+	};
+};
+
+struct BenchmarkInput
+{
+	BenchmarkShape shape_0;
+	BenchmarkShape shape_1;
+};
+
+// runs the test on `count` inputs, returns how many overlap
+typedef int (*BenchmarkRunner)(BenchmarkInput* inputs, int count);
+
+struct BenchmarkEntry
+{
+	const char*        name;
+	BenchmarkShapeType shape_0;
+	BenchmarkShapeType shape_1;
+	int                vertices_count; // of the polygons, 0 if there are none
+	BenchmarkRunner    run;
+};
+
+// one shape against many circles, stored in SoA layout (same as `itu_lib_overlaps_circle_circles()`)
+struct BenchmarkBatch
+{
+	vec2f  query_a;      // circle center, or segment start
+	vec2f  query_b;      // segment end
+	float  query_radius;
+	float* xs;
+	float* ys;
+	float* rs;
+	int*   hit_idxs;
+	int    count;
+};
+
+// runs one batch test on all circles, returns how many overlap
+typedef int (*BenchmarkBatchKernel)(BenchmarkBatch* batch);
+
+struct BenchmarkBatchVariant
+{
+	const char*          name;
+	BenchmarkBatchKernel circle_circles;
+	BenchmarkBatchKernel segment_circles;
+};
+
+// what gets timed: either a pair test on `inputs`, or a batch kernel on `batch`
+struct BenchmarkMeasure
+{
+	BenchmarkRunner      run;
+	BenchmarkInput*      inputs;
+	BenchmarkBatchKernel kernel;
+	BenchmarkBatch*      batch;
+	int                  count;         // tests per pass
+	int                  hits_expected; // per pass, to catch kernels that disagree with the reference
+};
+
+struct Benchmark
+{
+	Uint64 rng;
+	Arena  arena; // polygons of the current entry
+
+	// polygons are generated here, and moved to the arena only if the input is kept
+	vec2f scratch_vertices[2][BENCHMARK_VERTICES_MAX];
+	vec2f scratch_normals [2][BENCHMARK_VERTICES_MAX];
+
+	BenchmarkInput inputs_hit [BENCHMARK_INPUTS_COUNT];
+	BenchmarkInput inputs_miss[BENCHMARK_INPUTS_COUNT];
+	BenchmarkInput inputs     [BENCHMARK_MIX_MAX][BENCHMARK_INPUTS_COUNT];
+
+	SDL_IOStream* csv;
+	int           errors_count;
+};
+
+// keeps the result of every pass alive, so the compiler can't throw the tests away
+static volatile int benchmark_sink;
+
+// --------------------------------------------------------------------------------------------------------------------
+// pair tests
+// --------------------------------------------------------------------------------------------------------------------
+
+// NOTE: one loop per test, so the (inline) test function gets inlined in the loop and there is no call overhead per test
+#define BENCHMARK_RUNNER(name, test)                                   \
+	static int benchmark_run_##name(BenchmarkInput* inputs, int count) \
+	{                                                                  \
+		int hits_count = 0;                                            \
+		for(int i = 0; i < count; ++i)                                 \
+		{                                                              \
+			BenchmarkShape* s0 = &inputs[i].shape_0;                   \
+			BenchmarkShape* s1 = &inputs[i].shape_1;                   \
+			hits_count += (test);                                      \
+		}                                                              \
+		return hits_count;                                             \
+	}
+
+BENCHMARK_RUNNER(point_circle,    itu_lib_overlaps_point_circle(s0->a, s1->a, s1->radius))
+BENCHMARK_RUNNER(point_rect,      itu_lib_overlaps_point_rect(s0->a, s1->a, s1->b))
+BENCHMARK_RUNNER(segment_circle,  itu_lib_overlaps_segment_circle(s0->a, s0->b, s1->a, s1->radius))
+BENCHMARK_RUNNER(segment_segment, itu_lib_overlaps_segment_segment(s0->a, s0->b, s1->a, s1->b))
+BENCHMARK_RUNNER(segment_rect,    itu_lib_overlaps_segment_rect(s0->a, s0->b, s1->a, s1->b))
+BENCHMARK_RUNNER(circle_circle,   itu_lib_overlaps_circle_circle(s0->a, s0->radius, s1->a, s1->radius))
+BENCHMARK_RUNNER(circle_rect,     itu_lib_overlaps_circle_rect(s0->a, s0->radius, s1->a, s1->b))
+BENCHMARK_RUNNER(rect_rect,       itu_lib_overlaps_rect_rect(s0->a, s0->b, s1->a, s1->b))
+
+BENCHMARK_RUNNER(point_polygon,   itu_lib_overlaps_point_polygon(s0->a, s1->polygon.vertices, s1->polygon.vertices_count))
+BENCHMARK_RUNNER(segment_polygon, itu_lib_overlaps_segment_polygon(s0->a, s0->b, s1->polygon.vertices, s1->polygon.vertices_count))
+BENCHMARK_RUNNER(circle_polygon,  itu_lib_overlaps_circle_polygon(s0->a, s0->radius, s1->polygon.vertices, s1->polygon.vertices_count))
+BENCHMARK_RUNNER(rect_polygon,    itu_lib_overlaps_rect_polygon(s0->a, s0->b, s1->polygon.vertices, s1->polygon.vertices_count))
+BENCHMARK_RUNNER(polygon_polygon, itu_lib_overlaps_polygon_polygon(s0->polygon.vertices, s0->polygon.vertices_count, s1->polygon.vertices, s1->polygon.vertices_count, NULL, NULL))
+
+BENCHMARK_RUNNER(point_capsule,   itu_lib_overlaps_point_capsule(s0->a, s1->a, s1->b, s1->radius))
+BENCHMARK_RUNNER(segment_capsule, itu_lib_overlaps_segment_capsule(s0->a, s0->b, s1->a, s1->b, s1->radius))
+BENCHMARK_RUNNER(circle_capsule,  itu_lib_overlaps_circle_capsule(s0->a, s0->radius, s1->a, s1->b, s1->radius))
+BENCHMARK_RUNNER(capsule_capsule, itu_lib_overlaps_capsule_capsule(s0->a, s0->b, s0->radius, s1->a, s1->b, s1->radius))
+BENCHMARK_RUNNER(capsule_rect,    itu_lib_overlaps_capsule_rect(s0->a, s0->b, s0->radius, s1->a, s1->b))
+BENCHMARK_RUNNER(capsule_obb,     itu_lib_overlaps_capsule_obb(s0->a, s0->b, s0->radius, s1->obb))
+BENCHMARK_RUNNER(capsule_polygon, itu_lib_overlaps_capsule_polygon(s0->a, s0->b, s0->radius, s1->polygon.vertices, s1->polygon.vertices_count))
+
+BENCHMARK_RUNNER(point_obb,       itu_lib_overlaps_point_obb(s0->a, s1->obb))
+BENCHMARK_RUNNER(segment_obb,     itu_lib_overlaps_segment_obb(s0->a, s0->b, s1->obb))
+BENCHMARK_RUNNER(circle_obb,      itu_lib_overlaps_circle_obb(s0->a, s0->radius, s1->obb))
+BENCHMARK_RUNNER(rect_obb,        itu_lib_overlaps_rect_obb(s0->a, s0->b, s1->obb))
+BENCHMARK_RUNNER(obb_obb,         itu_lib_overlaps_obb_obb(s0->obb, s1->obb))
+BENCHMARK_RUNNER(obb_polygon,     itu_lib_overlaps_obb_polygon(s0->obb, s1->polygon.vertices, s1->polygon.vertices_count))
+
+BENCHMARK_RUNNER(point_convex_polygon,          itu_lib_overlaps_point_convex_polygon(s0->a, &s1->polygon))
+BENCHMARK_RUNNER(circle_convex_polygon,         itu_lib_overlaps_circle_convex_polygon(s0->a, s0->radius, &s1->polygon))
+BENCHMARK_RUNNER(convex_polygon_convex_polygon, itu_lib_overlaps_convex_polygon_convex_polygon(&s0->polygon, &s1->polygon))
+
+#define BENCHMARK_ENTRY(name, shape_0, shape_1, vertices_count) { #name, BENCHMARK_SHAPE_##shape_0, BENCHMARK_SHAPE_##shape_1, vertices_count, benchmark_run_##name }
+
+BenchmarkEntry BENCHMARK_ENTRIES[] = {
+	BENCHMARK_ENTRY(point_circle,    POINT,   CIRCLE,  0),
+	BENCHMARK_ENTRY(point_rect,      POINT,   RECT,    0),
+	BENCHMARK_ENTRY(segment_circle,  SEGMENT, CIRCLE,  0),
+	BENCHMARK_ENTRY(segment_segment, SEGMENT, SEGMENT, 0),
+	BENCHMARK_ENTRY(segment_rect,    SEGMENT, RECT,    0),
+	BENCHMARK_ENTRY(circle_circle,   CIRCLE,  CIRCLE,  0),
+	BENCHMARK_ENTRY(circle_rect,     CIRCLE,  RECT,    0),
+	BENCHMARK_ENTRY(rect_rect,       RECT,    RECT,    0),
+
+	BENCHMARK_ENTRY(point_polygon,   POINT,   POLYGON, BENCHMARK_VERTICES_DEFAULT),
+	BENCHMARK_ENTRY(segment_polygon, SEGMENT, POLYGON, BENCHMARK_VERTICES_DEFAULT),
+	BENCHMARK_ENTRY(circle_polygon,  CIRCLE,  POLYGON, BENCHMARK_VERTICES_DEFAULT),
+	BENCHMARK_ENTRY(rect_polygon,    RECT,    POLYGON, BENCHMARK_VERTICES_DEFAULT),
+	BENCHMARK_ENTRY(polygon_polygon, POLYGON, POLYGON, 3),
+	BENCHMARK_ENTRY(polygon_polygon, POLYGON, POLYGON, 4),
+	BENCHMARK_ENTRY(polygon_polygon, POLYGON, POLYGON, 8),
+	BENCHMARK_ENTRY(polygon_polygon, POLYGON, POLYGON, 16),
+	BENCHMARK_ENTRY(polygon_polygon, POLYGON, POLYGON, 32),
+
+	BENCHMARK_ENTRY(point_capsule,   POINT,   CAPSULE, 0),
+	BENCHMARK_ENTRY(segment_capsule, SEGMENT, CAPSULE, 0),
+	BENCHMARK_ENTRY(circle_capsule,  CIRCLE,  CAPSULE, 0),
+	BENCHMARK_ENTRY(capsule_capsule, CAPSULE, CAPSULE, 0),
+	BENCHMARK_ENTRY(capsule_rect,    CAPSULE, RECT,    0),
+	BENCHMARK_ENTRY(capsule_obb,     CAPSULE, OBB,     0),
+	BENCHMARK_ENTRY(capsule_polygon, CAPSULE, POLYGON, BENCHMARK_VERTICES_DEFAULT),
+
+	BENCHMARK_ENTRY(point_obb,       POINT,   OBB,     0),
+	BENCHMARK_ENTRY(segment_obb,     SEGMENT, OBB,     0),
+	BENCHMARK_ENTRY(circle_obb,      CIRCLE,  OBB,     0),
+	BENCHMARK_ENTRY(rect_obb,        RECT,    OBB,     0),
+	BENCHMARK_ENTRY(obb_obb,         OBB,     OBB,     0),
+	BENCHMARK_ENTRY(obb_polygon,     OBB,     POLYGON, BENCHMARK_VERTICES_DEFAULT),
+
+	BENCHMARK_ENTRY(point_convex_polygon,          POINT,   POLYGON, BENCHMARK_VERTICES_DEFAULT),
+	BENCHMARK_ENTRY(point_convex_polygon,          POINT,   POLYGON, BENCHMARK_VERTICES_MAX),
+	BENCHMARK_ENTRY(circle_convex_polygon,         CIRCLE,  POLYGON, BENCHMARK_VERTICES_DEFAULT),
+	BENCHMARK_ENTRY(circle_convex_polygon,         CIRCLE,  POLYGON, BENCHMARK_VERTICES_MAX),
+	BENCHMARK_ENTRY(convex_polygon_convex_polygon, POLYGON, POLYGON, 3),
+	BENCHMARK_ENTRY(convex_polygon_convex_polygon, POLYGON, POLYGON, 4),
+	BENCHMARK_ENTRY(convex_polygon_convex_polygon, POLYGON, POLYGON, 8),
+	BENCHMARK_ENTRY(convex_polygon_convex_polygon, POLYGON, POLYGON, 16),
+	BENCHMARK_ENTRY(convex_polygon_convex_polygon, POLYGON, POLYGON, 32),
+};
+
+static inline float benchmark_randf(Benchmark* benchmark, float min, float max)
+{
+	return min + SDL_randf_r(&benchmark->rng) * (max - min);
+}
+
+static inline vec2f benchmark_rand_direction(Benchmark* benchmark)
+{
+	float angle = benchmark_randf(benchmark, 0, TAU);
+	return vec2f{ SDL_cosf(angle), SDL_sinf(angle) };
+}
+
+// vertices on a circle, at (jittered) increasing angles, so the polygon is always convex and CCW
+static void benchmark_polygon_generate(Benchmark* benchmark, ConvexPolygon* polygon, vec2f* vertices, vec2f* normals, int vertices_count, vec2f center, float radius)
+{
+	SDL_assert(vertices_count >= 3 && vertices_count <= BENCHMARK_VERTICES_MAX);
+
+	float rotation = benchmark_randf(benchmark, 0, TAU);
+	float step     = TAU / vertices_count;
+	for(int i = 0; i < vertices_count; ++i)
+	{
+		float angle = rotation + (i + benchmark_randf(benchmark, 0, 0.5f)) * step;
+		vertices[i] = center + vec2f{ SDL_cosf(angle), SDL_sinf(angle) } * radius;
+	}
+	itu_lib_overlaps_convex_polygon_init(polygon, vertices, normals, vertices_count);
+}
+
+// `scratch_idx` selects which scratch buffers polygons are generated in (one per shape of the pair)
+static void benchmark_shape_generate(Benchmark* benchmark, BenchmarkShape* shape, BenchmarkShapeType type, vec2f center, int vertices_count, int scratch_idx)
+{
+	*shape = BenchmarkShape{ };
+
+	float size = benchmark_randf(benchmark, BENCHMARK_SIZE_MIN, BENCHMARK_SIZE_MAX);
+	switch(type)
+	{
+		case BENCHMARK_SHAPE_POINT:
+		{
+			shape->a = center;
+			break;
+		}
+		case BENCHMARK_SHAPE_SEGMENT:
+		{
+			vec2f half = benchmark_rand_direction(benchmark) * (size * 0.5f);
+			shape->a = center - half;
+			shape->b = center + half;
+			break;
+		}
+		case BENCHMARK_SHAPE_CIRCLE:
+		{
+			shape->a      = center;
+			shape->radius = size * 0.5f;
+			break;
+		}
+		case BENCHMARK_SHAPE_RECT:
+		{
+			vec2f half = vec2f{ benchmark_randf(benchmark, 0.25f, 0.5f), benchmark_randf(benchmark, 0.25f, 0.5f) } * size;
+			shape->a = center - half;
+			shape->b = center + half;
+			break;
+		}
+		case BENCHMARK_SHAPE_CAPSULE:
+		{
+			vec2f half = benchmark_rand_direction(benchmark) * (size * 0.3f);
+			shape->a      = center - half;
+			shape->b      = center + half;
+			shape->radius = size * 0.2f;
+			break;
+		}
+		case BENCHMARK_SHAPE_OBB:
+		{
+			vec2f half = vec2f{ benchmark_randf(benchmark, 0.25f, 0.5f), benchmark_randf(benchmark, 0.25f, 0.5f) } * size;
+			shape->obb = itu_lib_overlaps_obb_make(center, half, benchmark_randf(benchmark, 0, TAU));
+			break;
+		}
+		case BENCHMARK_SHAPE_POLYGON:
+		{
+			benchmark_polygon_generate(
+				benchmark, &shape->polygon,
+				benchmark->scratch_vertices[scratch_idx], benchmark->scratch_normals[scratch_idx], vertices_count,
+				center, size * 0.5f
+			);
+			break;
+		}
+		default: SDL_assert(false);
+	}
+}
+
+// moves the polygon (if any) out of the scratch buffers
+static void benchmark_shape_keep(Benchmark* benchmark, BenchmarkShape* shape, BenchmarkShapeType type)
+{
+	if(type != BENCHMARK_SHAPE_POLYGON)
+		return;
+
+	int count = shape->polygon.vertices_count;
+	vec2f* vertices = itu_lib_arena_alloc_array(&benchmark->arena, vec2f, count);
+	vec2f* normals  = itu_lib_arena_alloc_array(&benchmark->arena, vec2f, count);
+	SDL_memcpy(vertices, shape->polygon.vertices, count * sizeof(vec2f));
+	SDL_memcpy(normals,  shape->polygon.normals,  count * sizeof(vec2f));
+	shape->polygon.vertices = vertices;
+	shape->polygon.normals  = normals;
+}
+
+// generates random pairs until one overlaps (or not, depending on `hit`), using the test itself to decide
+// NOTE: both hits and misses come from the same distribution, so misses are mostly "near" misses
+static void benchmark_input_generate(Benchmark* benchmark, BenchmarkEntry* entry, bool hit, BenchmarkInput* out_input)
+{
+	for(int attempt = 0; attempt < BENCHMARK_ATTEMPTS_MAX; ++attempt)
+	{
+		vec2f center_0 = vec2f{ benchmark_randf(benchmark, 0, BENCHMARK_AREA), benchmark_randf(benchmark, 0, BENCHMARK_AREA) };
+		vec2f center_1 = center_0 + vec2f{ benchmark_randf(benchmark, -BENCHMARK_SPREAD, BENCHMARK_SPREAD), benchmark_randf(benchmark, -BENCHMARK_SPREAD, BENCHMARK_SPREAD) };
+
+		BenchmarkInput input;
+		benchmark_shape_generate(benchmark, &input.shape_0, entry->shape_0, center_0, entry->vertices_count, 0);
+		benchmark_shape_generate(benchmark, &input.shape_1, entry->shape_1, center_1, entry->vertices_count, 1);
+		if((entry->run(&input, 1) == 1) != hit)
+			continue;
+
+		benchmark_shape_keep(benchmark, &input.shape_0, entry->shape_0);
+		benchmark_shape_keep(benchmark, &input.shape_1, entry->shape_1);
+		*out_input = input;
+		return;
+	}
+
+	SDL_Log("[BENCHMARK] ERROR %s: could not generate a %s", entry->name, hit ? "hit" : "miss");
+	SDL_assert(false);
+}
+
+// fills all mixes of `benchmark->inputs`
+static void benchmark_inputs_generate(Benchmark* benchmark, BenchmarkEntry* entry)
+{
+	itu_lib_arena_reset(&benchmark->arena);
+	benchmark->rng = BENCHMARK_SEED;
+
+	for(int i = 0; i < BENCHMARK_INPUTS_COUNT; ++i)
+	{
+		benchmark_input_generate(benchmark, entry, true,  &benchmark->inputs_hit[i]);
+		benchmark_input_generate(benchmark, entry, false, &benchmark->inputs_miss[i]);
+	}
+
+	int half = BENCHMARK_INPUTS_COUNT / 2;
+	SDL_memcpy(benchmark->inputs[BENCHMARK_MIX_MISS], benchmark->inputs_miss, sizeof(benchmark->inputs_miss));
+	SDL_memcpy(benchmark->inputs[BENCHMARK_MIX_HIT],  benchmark->inputs_hit,  sizeof(benchmark->inputs_hit));
+	SDL_memcpy(benchmark->inputs[BENCHMARK_MIX_SORTED],        benchmark->inputs_hit,  half * sizeof(BenchmarkInput));
+	SDL_memcpy(benchmark->inputs[BENCHMARK_MIX_SORTED] + half, benchmark->inputs_miss, half * sizeof(BenchmarkInput));
+
+	// Fisher-Yates shuffle
+	BenchmarkInput* shuffled = benchmark->inputs[BENCHMARK_MIX_RANDOM];
+	SDL_memcpy(shuffled, benchmark->inputs[BENCHMARK_MIX_SORTED], BENCHMARK_INPUTS_COUNT * sizeof(BenchmarkInput));
+	for(int i = BENCHMARK_INPUTS_COUNT - 1; i > 0; --i)
+	{
+		int j = SDL_rand_r(&benchmark->rng, i + 1);
+		BenchmarkInput tmp = shuffled[i];
+		shuffled[i] = shuffled[j];
+		shuffled[j] = tmp;
+	}
+}
+
+static int benchmark_hits_expected(BenchmarkMix mix, int count)
+{
+	switch(mix)
+	{
+		case BENCHMARK_MIX_MISS: return 0;
+		case BENCHMARK_MIX_HIT:  return count;
+		default:                 return count / 2;
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// measuring
+// --------------------------------------------------------------------------------------------------------------------
+
+static inline int benchmark_pass(BenchmarkMeasure* measure)
+{
+	if(measure->run)
+		return measure->run(measure->inputs, measure->count);
+	return measure->kernel(measure->batch);
+}
+
+static int benchmark_ticks_compare(const void* a, const void* b)
+{
+	Uint64 ticks_a = *(const Uint64*)a;
+	Uint64 ticks_b = *(const Uint64*)b;
+	return ticks_a < ticks_b ? -1 : ticks_a > ticks_b ? 1 : 0;
+}
+
+// returns the median time of a single test, in nanoseconds
+// NOTE: a pass over all inputs can be way too short for the timer, so each repeat runs as many passes as needed
+//       to take at least `BENCHMARK_REPEAT_MIN_NS`
+static float benchmark_measure_ns(Benchmark* benchmark, BenchmarkMeasure* measure, const char* name)
+{
+	Uint64 frequency = SDL_GetPerformanceFrequency();
+	Uint64 ticks_min = BENCHMARK_REPEAT_MIN_NS * frequency / SECONDS(1);
+
+	// warmup, and check the results while we are at it
+	int hits_count = benchmark_pass(measure);
+	if(hits_count != measure->hits_expected)
+	{
+		SDL_Log("[BENCHMARK] ERROR %s: %d hits, expected %d", name, hits_count, measure->hits_expected);
+		benchmark->errors_count++;
+	}
+
+	int passes = 1;
+	for(;;)
+	{
+		Uint64 t0 = SDL_GetPerformanceCounter();
+		for(int i = 0; i < passes; ++i)
+			benchmark_sink = benchmark_pass(measure);
+		Uint64 t1 = SDL_GetPerformanceCounter();
+		if(t1 - t0 >= ticks_min)
+			break;
+		passes *= 2;
+	}
+
+	Uint64 ticks[BENCHMARK_REPEATS];
+	for(int r = 0; r < BENCHMARK_REPEATS; ++r)
+	{
+		Uint64 t0 = SDL_GetPerformanceCounter();
+		for(int i = 0; i < passes; ++i)
+			benchmark_sink = benchmark_pass(measure);
+		ticks[r] = SDL_GetPerformanceCounter() - t0;
+	}
+	SDL_qsort(ticks, BENCHMARK_REPEATS, sizeof(Uint64), benchmark_ticks_compare);
+
+	double ticks_per_test = (double)ticks[BENCHMARK_REPEATS / 2] / ((double)passes * measure->count);
+	return (float)(ticks_per_test * SECONDS(1) / (double)frequency);
+}
+
+static void benchmark_csv_row(Benchmark* benchmark, const char* function, const char* variant, int vertices_count, BenchmarkMix mix, float ns)
+{
+	SDL_IOprintf(
+		benchmark->csv, "%s,%s,%d,%s,%.2f,%.3f,%.1f\n",
+		function, variant, vertices_count, BENCHMARK_MIX_NAMES[mix],
+		benchmark_hits_expected(mix, BENCHMARK_INPUTS_COUNT) / (float)BENCHMARK_INPUTS_COUNT,
+		ns, 1000.0f / ns
+	);
+}
+
+static void benchmark_run_entry(Benchmark* benchmark, BenchmarkEntry* entry)
+{
+	benchmark_inputs_generate(benchmark, entry);
+
+	float ns[BENCHMARK_MIX_MAX];
+	for(int mix = 0; mix < BENCHMARK_MIX_MAX; ++mix)
+	{
+		BenchmarkMeasure measure = { };
+		measure.run           = entry->run;
+		measure.inputs        = benchmark->inputs[mix];
+		measure.count         = BENCHMARK_INPUTS_COUNT;
+		measure.hits_expected = benchmark_hits_expected((BenchmarkMix)mix, BENCHMARK_INPUTS_COUNT);
+
+		ns[mix] = benchmark_measure_ns(benchmark, &measure, entry->name);
+		benchmark_csv_row(benchmark, entry->name, "scalar", entry->vertices_count, (BenchmarkMix)mix, ns[mix]);
+	}
+
+	SDL_Log(
+		"[BENCHMARK] %-30s %2d vertices | miss %7.2f | hit %7.2f | sorted %7.2f | random %7.2f ns/op",
+		entry->name, entry->vertices_count,
+		ns[BENCHMARK_MIX_MISS], ns[BENCHMARK_MIX_HIT], ns[BENCHMARK_MIX_SORTED], ns[BENCHMARK_MIX_RANDOM]
+	);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// frame-coherent GJK
+// --------------------------------------------------------------------------------------------------------------------
+
+// the same pairs of polygons, moving a little every frame
+struct BenchmarkCoherentPair
+{
+	Shape shape_0;
+	Shape shape_1;
+	vec2f position_0;
+	vec2f position_1;
+	float phase;
+};
+
+static void benchmark_coherent_move(BenchmarkCoherentPair* pairs, int frame)
+{
+	for(int i = 0; i < BENCHMARK_COHERENT_PAIRS_COUNT; ++i)
+	{
+		BenchmarkCoherentPair* pair = &pairs[i];
+		float t = pair->phase + frame * 0.1f;
+		vec2f offset = vec2f{ SDL_cosf(t), SDL_sinf(t) } * BENCHMARK_COHERENT_AMPLITUDE;
+		itu_lib_overlaps_shape_set_transform(&pair->shape_0, pair->position_0 + offset, pair->phase + frame * 0.01f);
+		itu_lib_overlaps_shape_set_transform(&pair->shape_1, pair->position_1 - offset, pair->phase - frame * 0.01f);
+	}
+}
+
+// runs the pairs through all frames, with `table` (warm start) or without (cold start). Returns the time of a single test, in nanoseconds
+// NOTE: results of every test are written in `hits` (frame-major), so cold and warm can be compared
+static float benchmark_coherent_run(BenchmarkCoherentPair* pairs, PairTable* table, bool* hits, Sint64* out_iterations)
+{
+	Uint64 ticks = 0;
+	Sint64 iterations = 0;
+	for(int frame = 0; frame < BENCHMARK_COHERENT_FRAMES; ++frame)
+	{
+		benchmark_coherent_move(pairs, frame);
+
+		Uint64 t0 = SDL_GetPerformanceCounter();
+		for(int i = 0; i < BENCHMARK_COHERENT_PAIRS_COUNT; ++i)
+		{
+			GJKCache  cache_cold = { };
+			GJKCache* cache = table ? (GJKCache*)itu_lib_pairs_get(table, 2 * i, 2 * i + 1, NULL) : &cache_cold;
+			hits[frame * BENCHMARK_COHERENT_PAIRS_COUNT + i] = itu_lib_overlaps_gjk(&pairs[i].shape_0, &pairs[i].shape_1, cache, NULL, NULL);
+			iterations += cache->iterations;
+		}
+		if(table)
+			itu_lib_pairs_end_frame(table);
+		ticks += SDL_GetPerformanceCounter() - t0;
+	}
+
+	*out_iterations = iterations;
+	double tests_count = (double)BENCHMARK_COHERENT_FRAMES * BENCHMARK_COHERENT_PAIRS_COUNT;
+	return (float)((double)ticks * SECONDS(1) / (double)SDL_GetPerformanceFrequency() / tests_count);
+}
+
+static void benchmark_run_coherent(Benchmark* benchmark)
+{
+	itu_lib_arena_reset(&benchmark->arena);
+	benchmark->rng = BENCHMARK_SEED;
+
+	// about 3/4 of the pairs overlap, the rest are close but apart
+	BenchmarkCoherentPair* pairs = itu_lib_arena_alloc_array(&benchmark->arena, BenchmarkCoherentPair, BENCHMARK_COHERENT_PAIRS_COUNT);
+	for(int i = 0; i < BENCHMARK_COHERENT_PAIRS_COUNT; ++i)
+	{
+		BenchmarkCoherentPair* pair = &pairs[i];
+		Shape* shapes[2] = { &pair->shape_0, &pair->shape_1 };
+		float  radius[2];
+		for(int s = 0; s < 2; ++s)
+		{
+			vec2f* vertices = itu_lib_arena_alloc_array(&benchmark->arena, vec2f, BENCHMARK_VERTICES_DEFAULT);
+			vec2f* normals  = itu_lib_arena_alloc_array(&benchmark->arena, vec2f, BENCHMARK_VERTICES_DEFAULT);
+			ConvexPolygon polygon;
+			radius[s] = benchmark_randf(benchmark, BENCHMARK_SIZE_MIN, BENCHMARK_SIZE_MAX) * 0.5f;
+			benchmark_polygon_generate(benchmark, &polygon, vertices, normals, BENCHMARK_VERTICES_DEFAULT, VEC2F_ZERO, radius[s]);
+			*shapes[s] = itu_lib_overlaps_shape_polygon(vertices, BENCHMARK_VERTICES_DEFAULT);
+		}
+
+		pair->phase      = benchmark_randf(benchmark, 0, TAU);
+		pair->position_0 = vec2f{ BENCHMARK_AREA * 0.5f, BENCHMARK_AREA * 0.5f };
+		pair->position_1 = pair->position_0 + benchmark_rand_direction(benchmark) * ((radius[0] + radius[1]) * benchmark_randf(benchmark, 0.3f, 1.1f));
+	}
+
+	bool* hits_cold = itu_lib_arena_alloc_array(&benchmark->arena, bool, BENCHMARK_COHERENT_FRAMES * BENCHMARK_COHERENT_PAIRS_COUNT);
+	bool* hits_warm = itu_lib_arena_alloc_array(&benchmark->arena, bool, BENCHMARK_COHERENT_FRAMES * BENCHMARK_COHERENT_PAIRS_COUNT);
+
+	PairTable table;
+	itu_lib_pairs_init(&table, sizeof(GJKCache), BENCHMARK_COHERENT_PAIRS_COUNT * 2);
+
+	Sint64 iterations_cold, iterations_warm;
+	float ns_cold = benchmark_coherent_run(pairs, NULL,   hits_cold, &iterations_cold);
+	float ns_warm = benchmark_coherent_run(pairs, &table, hits_warm, &iterations_warm);
+	itu_lib_pairs_deinit(&table);
+
+	int tests_count = BENCHMARK_COHERENT_FRAMES * BENCHMARK_COHERENT_PAIRS_COUNT;
+	int hits_count  = 0;
+	int mismatches_count = 0;
+	for(int i = 0; i < tests_count; ++i)
+	{
+		hits_count       += hits_cold[i];
+		mismatches_count += hits_cold[i] != hits_warm[i];
+	}
+	if(mismatches_count > 0)
+	{
+		SDL_Log("[BENCHMARK] ERROR gjk_coherent: warm start disagrees with cold start on %d/%d tests", mismatches_count, tests_count);
+		benchmark->errors_count++;
+	}
+
+	float hit_ratio = hits_count / (float)tests_count;
+	SDL_IOprintf(benchmark->csv, "gjk_coherent,cold,%d,coherent,%.2f,%.3f,%.1f\n", BENCHMARK_VERTICES_DEFAULT, hit_ratio, ns_cold, 1000.0f / ns_cold);
+	SDL_IOprintf(benchmark->csv, "gjk_coherent,warm,%d,coherent,%.2f,%.3f,%.1f\n", BENCHMARK_VERTICES_DEFAULT, hit_ratio, ns_warm, 1000.0f / ns_warm);
+	SDL_Log(
+		"[BENCHMARK] %-30s %2d vertices | cold %7.2f ns/op, %.2f iterations | warm %7.2f ns/op, %.2f iterations",
+		"gjk_coherent", BENCHMARK_VERTICES_DEFAULT,
+		ns_cold, iterations_cold / (float)tests_count, ns_warm, iterations_warm / (float)tests_count
+	);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// contact checks
+// --------------------------------------------------------------------------------------------------------------------
+
+// how much the projections of two vertex lists on `axis` overlap (the first one being behind)
+static float benchmark_overlap_along(vec2f* vertices_0, int vertices_count_0, vec2f* vertices_1, int vertices_count_1, vec2f axis)
+{
+	float max_0 = -SDL_MAX_SINT32;
+	float min_1 =  SDL_MAX_SINT32;
+	for(int i = 0; i < vertices_count_0; ++i)
+		max_0 = SDL_max(max_0, dot(vertices_0[i], axis));
+	for(int i = 0; i < vertices_count_1; ++i)
+		min_1 = SDL_min(min_1, dot(vertices_1[i], axis));
+	return max_0 - min_1;
+}
+
+// EPA (starting from the GJK simplex) and SAT must agree on every overlapping pair of random polygons:
+// - same depth (in 2D the minimum translation is always along an edge normal, and SAT tries all of them)
+// - moving along the EPA normal by its depth must really separate the polygons
+// NOTE: the normals themselves are not compared, when two axes tie SAT and EPA can legitimately pick different ones
+static void benchmark_check_epa(Benchmark* benchmark)
+{
+	benchmark->rng = BENCHMARK_SEED;
+
+	int checks_count     = 0;
+	int mismatches_count = 0;
+	for(int i = 0; i < BENCHMARK_EPA_CHECKS_COUNT; ++i)
+	{
+		int   vertices_count_0 = 3 + SDL_rand_r(&benchmark->rng, BENCHMARK_VERTICES_MAX - 2);
+		int   vertices_count_1 = 3 + SDL_rand_r(&benchmark->rng, BENCHMARK_VERTICES_MAX - 2);
+		float radius_0         = benchmark_randf(benchmark, BENCHMARK_SIZE_MIN, BENCHMARK_SIZE_MAX) * 0.5f;
+		float radius_1         = benchmark_randf(benchmark, BENCHMARK_SIZE_MIN, BENCHMARK_SIZE_MAX) * 0.5f;
+		vec2f center_0         = vec2f{ BENCHMARK_AREA * 0.5f, BENCHMARK_AREA * 0.5f };
+		vec2f center_1         = center_0 + benchmark_rand_direction(benchmark) * benchmark_randf(benchmark, 0, radius_0 + radius_1);
+
+		vec2f* vertices_0 = benchmark->scratch_vertices[0];
+		vec2f* vertices_1 = benchmark->scratch_vertices[1];
+		ConvexPolygon polygon_0, polygon_1;
+		benchmark_polygon_generate(benchmark, &polygon_0, vertices_0, benchmark->scratch_normals[0], vertices_count_0, center_0, radius_0);
+		benchmark_polygon_generate(benchmark, &polygon_1, vertices_1, benchmark->scratch_normals[1], vertices_count_1, center_1, radius_1);
+
+		vec2f simplex[3];
+		int   simplex_count;
+		if(!itu_lib_overlaps_polygon_polygon(vertices_0, vertices_count_0, vertices_1, vertices_count_1, simplex, &simplex_count))
+			continue;
+
+		Contact contact_sat = { };
+		Contact contact_epa = { };
+		bool hit_sat = itu_lib_collide_polygon_polygon(vertices_0, vertices_count_0, vertices_1, vertices_count_1, &contact_sat);
+		bool hit_epa = itu_lib_collide_polygon_polygon_epa(vertices_0, vertices_count_0, vertices_1, vertices_count_1, simplex, simplex_count, &contact_epa);
+		float overlap_epa = benchmark_overlap_along(vertices_0, vertices_count_0, vertices_1, vertices_count_1, contact_epa.normal);
+		checks_count++;
+
+		// NOTE: GJK and SAT can disagree on pairs that are barely touching, that's fine as long as EPA finds (almost) no depth
+		if(!hit_sat && hit_epa && contact_epa.depth < BENCHMARK_EPA_TOLERANCE)
+			continue;
+
+		if(
+			!hit_sat || !hit_epa ||
+			SDL_fabsf(contact_sat.depth - contact_epa.depth) > BENCHMARK_EPA_TOLERANCE ||
+			SDL_fabsf(overlap_epa - contact_epa.depth) > BENCHMARK_EPA_TOLERANCE
+		)
+		{
+			SDL_Log(
+				"[BENCHMARK] ERROR EPA vs SAT (%d vs %d vertices): SAT %s depth %.4f, EPA %s depth %.4f (overlap along its normal %.4f)",
+				vertices_count_0, vertices_count_1, hit_sat ? "hit" : "miss", contact_sat.depth, hit_epa ? "hit" : "miss", contact_epa.depth, overlap_epa
+			);
+			mismatches_count++;
+		}
+	}
+
+	SDL_Log("[BENCHMARK] EPA vs SAT: %d/%d overlapping polygon pairs agree", checks_count - mismatches_count, checks_count);
+	benchmark->errors_count += mismatches_count;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// batch tests
+// --------------------------------------------------------------------------------------------------------------------
+
+// NOTE: the kernels below call the internal functions of itu_lib_overlaps directly, skipping the cpu detection,
+//       so they must only be used if the cpu supports them
+
+// reference: the single pair test in a loop, the way code not using the batch functions would do it
+static int benchmark_circle_circles_pairwise(BenchmarkBatch* batch)
+{
+	int hits_count = 0;
+	for(int i = 0; i < batch->count; ++i)
+		if(itu_lib_overlaps_circle_circle(batch->query_a, batch->query_radius, vec2f{ batch->xs[i], batch->ys[i] }, batch->rs[i]))
+			batch->hit_idxs[hits_count++] = i;
+	return hits_count;
+}
+
+static int benchmark_segment_circles_pairwise(BenchmarkBatch* batch)
+{
+	int hits_count = 0;
+	for(int i = 0; i < batch->count; ++i)
+		if(itu_lib_overlaps_segment_circle(batch->query_a, batch->query_b, vec2f{ batch->xs[i], batch->ys[i] }, batch->rs[i]))
+			batch->hit_idxs[hits_count++] = i;
+	return hits_count;
+}
+
+static int benchmark_circle_circles_dispatch(BenchmarkBatch* batch)
+{
+	return itu_lib_overlaps_circle_circles(batch->query_a, batch->query_radius, batch->xs, batch->ys, batch->rs, batch->count, batch->hit_idxs);
+}
+
+static int benchmark_segment_circles_dispatch(BenchmarkBatch* batch)
+{
+	return itu_lib_overlaps_segment_circles(batch->query_a, batch->query_b, batch->xs, batch->ys, batch->rs, batch->count, batch->hit_idxs);
+}
+
+// same setup as `itu_lib_overlaps_segment_circles()`
+static inline void benchmark_segment_setup(BenchmarkBatch* batch, vec2f* out_d, float* out_d_inv)
+{
+	*out_d = batch->query_b - batch->query_a;
+	float d_len_sq = dot(*out_d, *out_d);
+	*out_d_inv = d_len_sq > 0 ? 1.0f / d_len_sq : 0;
+}
+
+static int benchmark_circle_circles_scalar(BenchmarkBatch* batch)
+{
+	return overlaps_circle_circles_scalar(batch->query_a.x, batch->query_a.y, batch->query_radius, batch->xs, batch->ys, batch->rs, 0, batch->count, batch->hit_idxs, 0);
+}
+
+static int benchmark_segment_circles_scalar(BenchmarkBatch* batch)
+{
+	vec2f d; float d_inv;
+	benchmark_segment_setup(batch, &d, &d_inv);
+	return overlaps_segment_circles_scalar(batch->query_a.x, batch->query_a.y, d.x, d.y, d_inv, batch->xs, batch->ys, batch->rs, 0, batch->count, batch->hit_idxs, 0);
+}
+
+#if defined SDL_SSE2_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+static int benchmark_circle_circles_sse2(BenchmarkBatch* batch)
+{
+	return overlaps_circle_circles_sse2(batch->query_a.x, batch->query_a.y, batch->query_radius, batch->xs, batch->ys, batch->rs, batch->count, batch->hit_idxs);
+}
+
+static int benchmark_segment_circles_sse2(BenchmarkBatch* batch)
+{
+	vec2f d; float d_inv;
+	benchmark_segment_setup(batch, &d, &d_inv);
+	return overlaps_segment_circles_sse2(batch->query_a.x, batch->query_a.y, d.x, d.y, d_inv, batch->xs, batch->ys, batch->rs, batch->count, batch->hit_idxs);
+}
+#endif
+
+#if defined SDL_AVX2_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+static int benchmark_circle_circles_avx2(BenchmarkBatch* batch)
+{
+	return overlaps_circle_circles_avx2(batch->query_a.x, batch->query_a.y, batch->query_radius, batch->xs, batch->ys, batch->rs, batch->count, batch->hit_idxs);
+}
+
+static int benchmark_segment_circles_avx2(BenchmarkBatch* batch)
+{
+	vec2f d; float d_inv;
+	benchmark_segment_setup(batch, &d, &d_inv);
+	return overlaps_segment_circles_avx2(batch->query_a.x, batch->query_a.y, d.x, d.y, d_inv, batch->xs, batch->ys, batch->rs, batch->count, batch->hit_idxs);
+}
+#endif
+
+#if defined SDL_NEON_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+static int benchmark_circle_circles_neon(BenchmarkBatch* batch)
+{
+	return overlaps_circle_circles_neon(batch->query_a.x, batch->query_a.y, batch->query_radius, batch->xs, batch->ys, batch->rs, batch->count, batch->hit_idxs);
+}
+
+static int benchmark_segment_circles_neon(BenchmarkBatch* batch)
+{
+	vec2f d; float d_inv;
+	benchmark_segment_setup(batch, &d, &d_inv);
+	return overlaps_segment_circles_neon(batch->query_a.x, batch->query_a.y, d.x, d.y, d_inv, batch->xs, batch->ys, batch->rs, batch->count, batch->hit_idxs);
+}
+#endif
+
+// fills the circles of `batch` so that exactly `hits_count` of them overlap the query (the first ones, unless `shuffle`)
+static void benchmark_batch_generate(Benchmark* benchmark, BenchmarkBatch* batch, bool is_segment, int hits_count, bool shuffle)
+{
+	benchmark->rng = BENCHMARK_SEED;
+
+	for(int i = 0; i < batch->count; ++i)
+	{
+		bool hit = i < hits_count;
+		for(int attempt = 0; ; ++attempt)
+		{
+			SDL_assert(attempt < BENCHMARK_ATTEMPTS_MAX);
+
+			vec2f center = vec2f{ benchmark_randf(benchmark, 0, BENCHMARK_AREA), benchmark_randf(benchmark, 0, BENCHMARK_AREA) };
+			float radius = benchmark_randf(benchmark, BENCHMARK_SIZE_MIN, BENCHMARK_SIZE_MAX) * 0.25f;
+			bool overlaps = is_segment
+				? itu_lib_overlaps_segment_circle(batch->query_a, batch->query_b, center, radius)
+				: itu_lib_overlaps_circle_circle(batch->query_a, batch->query_radius, center, radius);
+			if(overlaps != hit)
+				continue;
+
+			batch->xs[i] = center.x;
+			batch->ys[i] = center.y;
+			batch->rs[i] = radius;
+			break;
+		}
+	}
+
+	if(!shuffle)
+		return;
+
+	for(int i = batch->count - 1; i > 0; --i)
+	{
+		int j = SDL_rand_r(&benchmark->rng, i + 1);
+		float x = batch->xs[i]; batch->xs[i] = batch->xs[j]; batch->xs[j] = x;
+		float y = batch->ys[i]; batch->ys[i] = batch->ys[j]; batch->ys[j] = y;
+		float r = batch->rs[i]; batch->rs[i] = batch->rs[j]; batch->rs[j] = r;
+	}
+}
+
+static void benchmark_run_batch(Benchmark* benchmark, BenchmarkBatch* batch, bool is_segment, BenchmarkBatchVariant* variants, int variants_count)
+{
+	const char* name = is_segment ? "segment_circles" : "circle_circles";
+
+	float ns[BENCHMARK_MIX_MAX][8];
+	SDL_assert(variants_count <= (int)array_size(ns[0]));
+
+	for(int mix = 0; mix < BENCHMARK_MIX_MAX; ++mix)
+	{
+		int hits_expected = benchmark_hits_expected((BenchmarkMix)mix, batch->count);
+		benchmark_batch_generate(benchmark, batch, is_segment, hits_expected, mix == BENCHMARK_MIX_RANDOM);
+
+		for(int v = 0; v < variants_count; ++v)
+		{
+			BenchmarkMeasure measure = { };
+			measure.kernel        = is_segment ? variants[v].segment_circles : variants[v].circle_circles;
+			measure.batch         = batch;
+			measure.count         = batch->count;
+			measure.hits_expected = hits_expected;
+
+			ns[mix][v] = benchmark_measure_ns(benchmark, &measure, name);
+			benchmark_csv_row(benchmark, name, variants[v].name, 0, (BenchmarkMix)mix, ns[mix][v]);
+		}
+	}
+
+	for(int v = 0; v < variants_count; ++v)
+	{
+		SDL_Log(
+			"[BENCHMARK] %-21s %-8s | miss %7.2f | hit %7.2f | sorted %7.2f | random %7.2f ns/circle",
+			name, variants[v].name,
+			ns[BENCHMARK_MIX_MISS][v], ns[BENCHMARK_MIX_HIT][v], ns[BENCHMARK_MIX_SORTED][v], ns[BENCHMARK_MIX_RANDOM][v]
+		);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* csv_path = argc > 1 ? argv[1] : "overlaps_benchmark.csv";
+
+	static Benchmark benchmark = { };
+	benchmark.csv = SDL_IOFromFile(csv_path, "w");
+	VALIDATE_PANIC(benchmark.csv);
+
+	// NOTE: enough for two polygons with the most vertices per input, for both hits and misses
+	itu_lib_arena_init(&benchmark.arena, BENCHMARK_INPUTS_COUNT * 2 * 2 * 2 * BENCHMARK_VERTICES_MAX * sizeof(vec2f));
+
+	SDL_IOprintf(benchmark.csv, "function,variant,vertices,mix,hit_ratio,ns_per_op,mops_per_s\n");
+
+	benchmark_check_epa(&benchmark);
+
+	for(int i = 0; i < (int)array_size(BENCHMARK_ENTRIES); ++i)
+		benchmark_run_entry(&benchmark, &BENCHMARK_ENTRIES[i]);
+
+	benchmark_run_coherent(&benchmark);
+
+	// only the kernels this machine can run
+	BenchmarkBatchVariant variants[8];
+	int variants_count = 0;
+	variants[variants_count++] = BenchmarkBatchVariant{ "pairwise", benchmark_circle_circles_pairwise, benchmark_segment_circles_pairwise };
+	variants[variants_count++] = BenchmarkBatchVariant{ "scalar",   benchmark_circle_circles_scalar,   benchmark_segment_circles_scalar };
+#if defined SDL_SSE2_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+	if(SDL_HasSSE2())
+		variants[variants_count++] = BenchmarkBatchVariant{ "sse2", benchmark_circle_circles_sse2, benchmark_segment_circles_sse2 };
+#endif
+#if defined SDL_AVX2_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+	if(SDL_HasAVX2())
+		variants[variants_count++] = BenchmarkBatchVariant{ "avx2", benchmark_circle_circles_avx2, benchmark_segment_circles_avx2 };
+#endif
+#if defined SDL_NEON_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+	variants[variants_count++] = BenchmarkBatchVariant{ "neon", benchmark_circle_circles_neon, benchmark_segment_circles_neon };
+#endif
+	variants[variants_count++] = BenchmarkBatchVariant{ "dispatch", benchmark_circle_circles_dispatch, benchmark_segment_circles_dispatch };
+
+	BenchmarkBatch batch = { };
+	batch.count        = BENCHMARK_CIRCLES_COUNT;
+	batch.xs           = (float*)SDL_malloc(batch.count * sizeof(float));
+	batch.ys           = (float*)SDL_malloc(batch.count * sizeof(float));
+	batch.rs           = (float*)SDL_malloc(batch.count * sizeof(float));
+	batch.hit_idxs     = (int*)  SDL_malloc(batch.count * sizeof(int));
+	SDL_assert(batch.xs && batch.ys && batch.rs && batch.hit_idxs);
+
+	batch.query_a      = vec2f{ BENCHMARK_AREA * 0.5f, BENCHMARK_AREA * 0.5f };
+	batch.query_radius = BENCHMARK_AREA * 0.2f;
+	benchmark_run_batch(&benchmark, &batch, false, variants, variants_count);
+
+	batch.query_a      = vec2f{ BENCHMARK_AREA * 0.2f, BENCHMARK_AREA * 0.3f };
+	batch.query_b      = vec2f{ BENCHMARK_AREA * 0.8f, BENCHMARK_AREA * 0.7f };
+	benchmark_run_batch(&benchmark, &batch, true, variants, variants_count);
+
+	SDL_free(batch.xs);
+	SDL_free(batch.ys);
+	SDL_free(batch.rs);
+	SDL_free(batch.hit_idxs);
+	itu_lib_arena_deinit(&benchmark.arena);
+
+	SDL_CloseIO(benchmark.csv);
+	SDL_Log("[BENCHMARK] results written to %s", csv_path);
+	return benchmark.errors_count > 0 ? 1 : 0;
+}
@@ -12,6 +12,8 @@
 #define ENABLE_DIAGNOSTICS
 
 #define TARGET_FRAMERATE SECONDS(1) / 60
+#define SIM_HZ           ITU_ENGINE_SIM_HZ_DEFAULT        // simulation rate, independent from the framerate (ie, 30 on loaded servers)
+#define SIM_STEPS_MAX    ITU_ENGINE_SIM_STEPS_MAX_DEFAULT // max catch-up steps per frame
 #define WINDOW_W         1280
 #define WINDOW_H         720
 
@@ -28,6 +30,7 @@ struct Entity {
     EntityType type;
     Sprite sprite;
     Transform transform;
+    Transform transform_prev; // transform at the previous simulation step, rendering interpolates between the two
 };
 
 struct GameState {
@@ -114,11 +117,20 @@ static void game_reset(SDLContext *context, GameState *state) {
         // Raise sprite pivot so the position coincides with the center of the image
         state->player->sprite.pivot.y = 0.3f;
     }
+
+    // nothing moved yet
+    for (int i = 0; i < state->entities_alive_count; ++i)
+        state->entities[i].transform_prev = state->entities[i].transform;
 }
 
-// Updates the game state each frame.
-// Handles player movement based on input and updates the camera to follow the player.
-static void game_update(SDLContext *context, GameState *state) { {
+// Advances the simulation by a single fixed step (`context->sim_delta`), may run zero or more times per frame.
+// Handles player movement based on input.
+static void game_update(SDLContext *context, GameState *state) {
+    // keep the last state, so rendering can interpolate
+    for (int i = 0; i < state->entities_alive_count; ++i)
+        state->entities[i].transform_prev = state->entities[i].transform;
+
+    {
         const float player_speed = 3;
 
         Entity *entity = state->player;
@@ -132,13 +144,17 @@ static void game_update(SDLContext *context, GameState *state) { {
         if (context->btn_isdown_right)
             mov.x += 1;
 
-        entity->transform.position = entity->transform.position + mov * (player_speed * context->delta);
+        entity->transform.position = entity->transform.position + mov * (player_speed * context->sim_delta);
     }
+}
 
-    // camera follows player
+// Updates everything that follows the framerate rather than the simulation, once per frame.
+// Makes the camera follow the (interpolated) player and handles zoom.
+static void game_update_frame(SDLContext *context, GameState *state) {
     const float zoom_speed = 1;
 
-    context->camera_active->world_position = state->player->transform.position;
+    Transform player_transform = transform_interpolate(&state->player->transform_prev, &state->player->transform, context->sim_alpha);
+    context->camera_active->world_position = player_transform.position;
     context->camera_active->zoom += context->mouse_scroll * zoom_speed * context->delta;
 }
 
@@ -152,9 +168,10 @@ static void game_render(SDLContext *context, GameState *state) {
     for (int i = 0; i < state->entities_alive_count; ++i) {
         Entity *entity = &state->entities[i];
 
-        // get entity data
-        vec2f pos = entity->transform.position;
-        vec2f scale = entity->transform.scale;
+        // get entity data, between the last two simulation steps
+        Transform transform = transform_interpolate(&entity->transform_prev, &entity->transform, context->sim_alpha);
+        vec2f pos = transform.position;
+        vec2f scale = transform.scale;
 
         // move entity into camera relative space
         pos = pos - cam_pos;
@@ -174,7 +191,7 @@ static void game_render(SDLContext *context, GameState *state) {
         SDL_RenderTexture(context->renderer, entity->sprite.texture, &entity->sprite.rect, &rect_dst);
 
         if (DEBUG_render_outlines) {
-            itu_lib_sprite_render_debug(context, &entity->sprite, &entity->transform);
+            itu_lib_sprite_render_debug(context, &entity->sprite, &transform);
         }
     }
 
@@ -205,6 +222,8 @@ int main(int argc, char *argv[]) {
 
     context.camera_active = &context.camera_default;
 
+    sdl_timestep_init(&context, SIM_HZ, SIM_STEPS_MAX);
+
     game_init(&context, &state);
     game_reset(&context, &state);
 
@@ -212,7 +231,7 @@ int main(int argc, char *argv[]) {
     SDL_Time walltime_frame_end;
     SDL_Time walltime_work_end;
     SDL_Time elapsed_work;
-    SDL_Time elapsed_frame;
+    SDL_Time elapsed_frame = 0;
 
     SDL_GetCurrentTime(&walltime_frame_beg);
     walltime_frame_end = walltime_frame_beg;
@@ -256,7 +275,10 @@ int main(int argc, char *argv[]) {
         SDL_RenderClear(context.renderer);
 
         // update
-        game_update(&context, &state);
+        sdl_timestep_accumulate(&context, elapsed_frame);
+        while (sdl_timestep_step(&context))
+            game_update(&context, &state);
+        game_update_frame(&context, &state);
         game_render(&context, &state);
 
         SDL_GetCurrentTime(&walltime_work_end);
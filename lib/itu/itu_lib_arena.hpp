@@ -0,0 +1,154 @@
+// itu_lib_arena.hpp
+// linear (bump) allocator for memory that all dies at the same time (ie, everything allocated during a frame)
+//
+// usage:
+// - allocate with `itu_lib_arena_alloc()`, there is no free
+// - call `itu_lib_arena_reset()` when all of it can go away (ie, at the beginning of the frame)
+//
+// important notes:
+// - memory comes in chunks of `chunk_size` bytes (or bigger, for big allocations), chained in a list.
+//   When a chunk is full we move to the next one, and only allocate a new one when we run out
+// - reset is O(1), chunks are kept and reused (they are only released by `itu_lib_arena_deinit()`)
+// - allocations never move, pointers stay valid until the next reset
+// - `used_max` is the high-water mark (bytes handed out, alignment padding and skipped chunk ends included), useful to size `chunk_size`
+//
+// SDL functions used here:
+// - SDL_malloc(), SDL_free()
+
+#ifndef ITU_LIB_ARENA_HPP
+#define ITU_LIB_ARENA_HPP
+
+#include <itu_common.hpp>
+
+#define ITU_LIB_ARENA_ALIGNMENT_DEFAULT 16
+
+struct ArenaChunk
+{
+	ArenaChunk* next;
+	Sint64      size;  // usable bytes, after the header
+	Sint64      used;
+};
+
+struct Arena
+{
+	ArenaChunk* first;
+	ArenaChunk* current;
+	Sint64      chunk_size;
+	Sint64      capacity;   // sum of the sizes of all chunks
+	Sint64      used;       // since the last reset
+	Sint64      used_max;   // highest `used` ever reached
+	int         chunks_count;
+};
+
+void  itu_lib_arena_init(Arena* arena, Sint64 chunk_size);
+void  itu_lib_arena_deinit(Arena* arena);
+void  itu_lib_arena_reset(Arena* arena);
+void* itu_lib_arena_alloc(Arena* arena, Sint64 size, Sint64 alignment);
+
+#define itu_lib_arena_alloc_array(arena, type, count) ((type*)itu_lib_arena_alloc((arena), sizeof(type) * (count), alignof(type)))
+
+#if defined ITU_LIB_ARENA_IMPLEMENTATION || defined ITU_UNITY_BUILD
+
+// the header of a chunk, padded so data starts aligned
+#define ITU_LIB_ARENA_HEADER_SIZE ((Sint64)((sizeof(ArenaChunk) + ITU_LIB_ARENA_ALIGNMENT_DEFAULT - 1) & ~(ITU_LIB_ARENA_ALIGNMENT_DEFAULT - 1)))
+
+static inline Uint8* arena_chunk_data(ArenaChunk* chunk)
+{
+	return (Uint8*)chunk + ITU_LIB_ARENA_HEADER_SIZE;
+}
+
+static ArenaChunk* arena_chunk_create(Arena* arena, Sint64 size)
+{
+	ArenaChunk* chunk = (ArenaChunk*)SDL_malloc(ITU_LIB_ARENA_HEADER_SIZE + size);
+	SDL_assert(chunk);
+
+	chunk->next = NULL;
+	chunk->size = size;
+	chunk->used = 0;
+
+	arena->capacity += size;
+	arena->chunks_count++;
+	return chunk;
+}
+
+// `chunk_size` is the size of each block of memory requested to the system
+void itu_lib_arena_init(Arena* arena, Sint64 chunk_size)
+{
+	SDL_assert(arena);
+	SDL_assert(chunk_size > 0);
+
+	*arena = Arena{ };
+	arena->chunk_size = chunk_size;
+	arena->first      = arena_chunk_create(arena, chunk_size);
+	arena->current    = arena->first;
+}
+
+void itu_lib_arena_deinit(Arena* arena)
+{
+	ArenaChunk* chunk = arena->first;
+	while(chunk)
+	{
+		ArenaChunk* next = chunk->next;
+		SDL_free(chunk);
+		chunk = next;
+	}
+	*arena = Arena{ };
+}
+
+// throws away everything allocated so far
+// NOTE: only the first chunk is cleared here, the others are cleared when we get to them again
+void itu_lib_arena_reset(Arena* arena)
+{
+	arena->current = arena->first;
+	arena->current->used = 0;
+	arena->used = 0;
+}
+
+// returns `size` bytes aligned to `alignment` (a power of two, at most `ITU_LIB_ARENA_ALIGNMENT_DEFAULT`)
+// NOTE: memory is not cleared
+void* itu_lib_arena_alloc(Arena* arena, Sint64 size, Sint64 alignment)
+{
+	SDL_assert(arena && arena->first);
+	SDL_assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && alignment <= ITU_LIB_ARENA_ALIGNMENT_DEFAULT);
+
+	ArenaChunk* chunk = arena->current;
+	Sint64 offset = (chunk->used + alignment - 1) & ~(alignment - 1);
+	if(offset + size > chunk->size)
+	{
+		// move to the first of the following chunks that is big enough (bringing it right after the current one),
+		// only create a new one if there is none
+		// NOTE: chunks too small for this allocation stay where they are, the next allocations can still use them
+		ArenaChunk* prev = chunk;
+		ArenaChunk* next = chunk->next;
+		while(next && next->size < size)
+		{
+			prev = next;
+			next = next->next;
+		}
+
+		if(next)
+			prev->next = next->next;
+		else
+			next = arena_chunk_create(arena, SDL_max(arena->chunk_size, size));
+		next->next  = chunk->next;
+		chunk->next = next;
+
+		// the unused end of the old chunk counts as used, we are not going back there until the next reset
+		arena->used += chunk->size - chunk->used;
+
+		chunk = next;
+		chunk->used = 0;
+		arena->current = chunk;
+		offset = 0;
+	}
+
+	void* ret = arena_chunk_data(chunk) + offset;
+	arena->used += offset + size - chunk->used;
+	arena->used_max = SDL_max(arena->used_max, arena->used);
+	chunk->used = offset + size;
+	return ret;
+}
+
+#endif // ITU_LIB_ARENA_IMPLEMENTATION
+
+#endif // ITU_LIB_ARENA_HPP
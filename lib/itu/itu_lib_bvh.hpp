@@ -0,0 +1,963 @@
+// itu_lib_bvh.hpp
+// dynamic bounding volume hierarchy (a binary tree of AABBs) to find pairs of potentially overlapping shapes
+// mostly a simplified version of Box2D's dynamic tree (https://github.com/erincatto/box2d), see also
+// https://box2d.org/files/ErinCatto_DynamicBVH_GDC2019.pdf for a great explanation of the techniques used here
+//
+// features:
+// - leaves can store any `Shape` from itu_lib_overlaps.hpp (circles, rects, capsules, polygons, with their transform)
+// - leaves use "fat" AABBs (enlarged by `margin`), so shapes that moved only a bit don't need to touch the tree
+// - the tree is rebalanced with rotations every time a leaf is inserted or removed, so it never degenerates into a list
+// - pair queries inside a tree and between two different trees, and AABB queries
+// - collision layers: every leaf has a layer and a mask, and every internal node keeps the OR of the leaves below it,
+//   so whole subtrees that can't produce a compatible pair are skipped without being walked
+// - raycasts (first hit, all hits, and batches of rays that walk the tree together)
+//
+// important notes:
+// - nodes are referenced by index, never by pointer (the node pool can be reallocated when growing)
+// - pair queries only test fat AABBs, running the actual overlap test (ie, `itu_lib_overlaps_shape_shape()`) is up to the caller
+// - every query walks the tree depth-first in a fixed order, so results are always reported in the same order
+// - queries use the tree's scratch stack, so only one query at a time can run on the same tree
+// - raycasts test the actual shapes (with `itu_lib_sweep_segment_shape()`), not just the fat AABBs
+// - two leaves are compatible if the layer of each one is in the mask of the other. New leaves are in
+//   `ITU_LIB_BVH_LAYER_DEFAULT` and collide with everything, use `itu_lib_bvh_set_filter()` to change that
+//
+// SDL functions used here (all coming from `itu_common`):
+// - SDL_realloc()
+// - SDL_free()
+// - SDL_assert()
+
+#ifndef ITU_LIB_BVH_HPP
+#define ITU_LIB_BVH_HPP
+
+#include <itu_common.hpp>
+#include <itu_lib_overlaps.hpp>
+
+#define ITU_LIB_BVH_NULL_NODE -1
+
+#define ITU_LIB_BVH_LAYER_DEFAULT (1u << 0)
+#define ITU_LIB_BVH_MASK_ALL      SDL_MAX_UINT32
+
+struct BVHNode
+{
+	vec2f aabb_min;   // NOTE: for leaves, this is the fat AABB
+	vec2f aabb_max;
+
+	int parent;       // also used as "next" when the node is in the free list
+	int child_0;
+	int child_1;
+	int height;       // leaves have height 0, free nodes have height -1
+
+	Uint32 layers;    // for leaves, the layer of the shape. For internal nodes, the OR of all leaves below
+	Uint32 masks;     // same, with masks
+
+	// leaves only
+	Shape  shape;
+	Uint32 user_id;
+};
+
+struct BVH
+{
+	BVHNode* nodes;
+	int      nodes_capacity;
+	int      nodes_count;    // nodes currently in use (leaves and internal nodes)
+
+	int root;
+	int free_list;
+
+	float margin;            // how much leaf AABBs get enlarged on each side
+
+	// scratch memory used by queries
+	int* stack;
+	int  stack_capacity;
+};
+
+// result of a raycast
+// - `leaf` is `ITU_LIB_BVH_NULL_NODE` if the ray didn't hit anything
+// - `toi` is how far along the ray the hit is, in [0, 1] (ie, the hit point is `ray_a + (ray_b - ray_a) * toi`)
+// - `normal` goes from the ray towards the shape hit (same as `itu_lib_sweep_*`)
+struct BVHRaycastHit
+{
+	int    leaf;
+	Uint32 user_id;
+	float  toi;
+	vec2f  normal;
+};
+
+// how many rays `itu_lib_bvh_raycast_batch()` walks down the tree together
+#define ITU_LIB_BVH_RAYCAST_PACKET_SIZE 32
+
+// return false to stop the query
+typedef bool (*BVHQueryCallback)(void* userdata, Uint32 user_id);
+typedef bool (*BVHPairCallback)(void* userdata, Uint32 user_id_0, Uint32 user_id_1);
+
+void itu_lib_bvh_init(BVH* bvh, float margin, int nodes_capacity);
+void itu_lib_bvh_deinit(BVH* bvh);
+void itu_lib_bvh_clear(BVH* bvh);
+int  itu_lib_bvh_insert(BVH* bvh, Shape* shape, Uint32 user_id);
+void itu_lib_bvh_remove(BVH* bvh, int leaf);
+bool itu_lib_bvh_move(BVH* bvh, int leaf, Shape* shape);
+void itu_lib_bvh_set_filter(BVH* bvh, int leaf, Uint32 layer, Uint32 mask);
+int  itu_lib_bvh_get_height(BVH* bvh);
+void itu_lib_bvh_query_aabb(BVH* bvh, vec2f aabb_min, vec2f aabb_max, Uint32 mask, BVHQueryCallback callback, void* userdata);
+void itu_lib_bvh_query_pairs(BVH* bvh, BVHPairCallback callback, void* userdata);
+void itu_lib_bvh_query_pairs_tree(BVH* bvh_0, BVH* bvh_1, BVHPairCallback callback, void* userdata);
+bool itu_lib_bvh_raycast(BVH* bvh, vec2f ray_a, vec2f ray_b, BVHRaycastHit* out_hit);
+int  itu_lib_bvh_raycast_all(BVH* bvh, vec2f ray_a, vec2f ray_b, BVHRaycastHit* out_hits, int out_hits_capacity);
+int  itu_lib_bvh_raycast_batch(BVH* bvh, vec2f* rays_a, vec2f* rays_b, int rays_count, BVHRaycastHit* out_hits);
+
+#if defined ITU_LIB_BVH_IMPLEMENTATION || defined ITU_UNITY_BUILD
+
+static inline bool bvh_node_is_leaf(BVHNode* node)
+{
+	return node->child_0 == ITU_LIB_BVH_NULL_NODE;
+}
+
+static inline bool bvh_aabb_overlaps(BVHNode* a, BVHNode* b)
+{
+	return itu_lib_overlaps_rect_rect(a->aabb_min, a->aabb_max, b->aabb_min, b->aabb_max);
+}
+
+// NOTE: for internal nodes this is conservative, it can only say that no pair between the two subtrees is compatible
+static inline bool bvh_filters_match(BVHNode* a, BVHNode* b)
+{
+	return (a->layers & b->masks) && (b->layers & a->masks);
+}
+
+static inline bool bvh_aabb_contains(vec2f outer_min, vec2f outer_max, vec2f inner_min, vec2f inner_max)
+{
+	return outer_min.x <= inner_min.x && outer_min.y <= inner_min.y && outer_max.x >= inner_max.x && outer_max.y >= inner_max.y;
+}
+
+// in 2D we use the perimeter as the "surface area" of the surface area heuristic
+static inline float bvh_aabb_perimeter(vec2f aabb_min, vec2f aabb_max)
+{
+	return 2 * ((aabb_max.x - aabb_min.x) + (aabb_max.y - aabb_min.y));
+}
+
+static inline void bvh_node_refit(BVH* bvh, int node_idx)
+{
+	BVHNode* node = &bvh->nodes[node_idx];
+	BVHNode* child_0 = &bvh->nodes[node->child_0];
+	BVHNode* child_1 = &bvh->nodes[node->child_1];
+
+	node->aabb_min.x = SDL_min(child_0->aabb_min.x, child_1->aabb_min.x);
+	node->aabb_min.y = SDL_min(child_0->aabb_min.y, child_1->aabb_min.y);
+	node->aabb_max.x = SDL_max(child_0->aabb_max.x, child_1->aabb_max.x);
+	node->aabb_max.y = SDL_max(child_0->aabb_max.y, child_1->aabb_max.y);
+	node->height = 1 + SDL_max(child_0->height, child_1->height);
+	node->layers = child_0->layers | child_1->layers;
+	node->masks  = child_0->masks  | child_1->masks;
+}
+
+static int bvh_node_alloc(BVH* bvh)
+{
+	if(bvh->free_list == ITU_LIB_BVH_NULL_NODE)
+	{
+		// grow the pool and chain all new nodes in the free list
+		int capacity_old = bvh->nodes_capacity;
+		int capacity_new = SDL_max(capacity_old * 2, 16);
+		bvh->nodes = (BVHNode*)SDL_realloc(bvh->nodes, capacity_new * sizeof(BVHNode));
+		SDL_assert(bvh->nodes);
+
+		for(int i = capacity_old; i < capacity_new; ++i)
+		{
+			bvh->nodes[i].parent = i + 1 < capacity_new ? i + 1 : ITU_LIB_BVH_NULL_NODE;
+			bvh->nodes[i].height = -1;
+		}
+		bvh->free_list = capacity_old;
+		bvh->nodes_capacity = capacity_new;
+	}
+
+	int ret = bvh->free_list;
+	BVHNode* node = &bvh->nodes[ret];
+	bvh->free_list = node->parent;
+
+	node->parent  = ITU_LIB_BVH_NULL_NODE;
+	node->child_0 = ITU_LIB_BVH_NULL_NODE;
+	node->child_1 = ITU_LIB_BVH_NULL_NODE;
+	node->height  = 0;
+	node->user_id = 0;
+	node->layers  = ITU_LIB_BVH_LAYER_DEFAULT;
+	node->masks   = ITU_LIB_BVH_MASK_ALL;
+	bvh->nodes_count++;
+
+	return ret;
+}
+
+static void bvh_node_free(BVH* bvh, int node_idx)
+{
+	SDL_assert(node_idx >= 0 && node_idx < bvh->nodes_capacity);
+	SDL_assert(bvh->nodes[node_idx].height >= 0);
+
+	bvh->nodes[node_idx].parent = bvh->free_list;
+	bvh->nodes[node_idx].height = -1;
+	bvh->free_list = node_idx;
+	bvh->nodes_count--;
+}
+
+static void bvh_stack_push(BVH* bvh, int* stack_count, int value)
+{
+	if(*stack_count == bvh->stack_capacity)
+	{
+		bvh->stack_capacity = SDL_max(bvh->stack_capacity * 2, 64);
+		bvh->stack = (int*)SDL_realloc(bvh->stack, bvh->stack_capacity * sizeof(int));
+		SDL_assert(bvh->stack);
+	}
+	bvh->stack[(*stack_count)++] = value;
+}
+
+// if the subtree rooted in `a` is unbalanced, rotates one of its children up (AVL-style)
+// returns the index of the new root of the subtree
+/* rotation (when c is taller than b)
+ *
+ *        a                c
+ *       / \              / \
+ *      b   c     -->     a   f    (f or g, whichever is taller, stays with c)
+ *         / \           / \
+ *        f   g         b   g
+ */
+static int bvh_balance(BVH* bvh, int idx_a)
+{
+	BVHNode* a = &bvh->nodes[idx_a];
+	if(bvh_node_is_leaf(a) || a->height < 2)
+		return idx_a;
+
+	int idx_b = a->child_0;
+	int idx_c = a->child_1;
+	BVHNode* b = &bvh->nodes[idx_b];
+	BVHNode* c = &bvh->nodes[idx_c];
+
+	int balance = c->height - b->height;
+
+	// rotate c up
+	if(balance > 1)
+	{
+		int idx_f = c->child_0;
+		int idx_g = c->child_1;
+		BVHNode* f = &bvh->nodes[idx_f];
+		BVHNode* g = &bvh->nodes[idx_g];
+
+		// swap a and c
+		c->child_0 = idx_a;
+		c->parent = a->parent;
+		a->parent = idx_c;
+
+		// a's old parent should point to c
+		if(c->parent != ITU_LIB_BVH_NULL_NODE)
+		{
+			BVHNode* parent = &bvh->nodes[c->parent];
+			if(parent->child_0 == idx_a)
+				parent->child_0 = idx_c;
+			else
+				parent->child_1 = idx_c;
+		}
+		else
+		{
+			bvh->root = idx_c;
+		}
+
+		// the taller of f and g stays with c, the other one goes to a
+		if(f->height > g->height)
+		{
+			c->child_1 = idx_f;
+			a->child_1 = idx_g;
+			g->parent = idx_a;
+		}
+		else
+		{
+			c->child_1 = idx_g;
+			a->child_1 = idx_f;
+			f->parent = idx_a;
+		}
+		bvh_node_refit(bvh, idx_a);
+		bvh_node_refit(bvh, idx_c);
+
+		return idx_c;
+	}
+
+	// rotate b up (mirror of the case above)
+	if(balance < -1)
+	{
+		int idx_d = b->child_0;
+		int idx_e = b->child_1;
+		BVHNode* d = &bvh->nodes[idx_d];
+		BVHNode* e = &bvh->nodes[idx_e];
+
+		b->child_0 = idx_a;
+		b->parent = a->parent;
+		a->parent = idx_b;
+
+		if(b->parent != ITU_LIB_BVH_NULL_NODE)
+		{
+			BVHNode* parent = &bvh->nodes[b->parent];
+			if(parent->child_0 == idx_a)
+				parent->child_0 = idx_b;
+			else
+				parent->child_1 = idx_b;
+		}
+		else
+		{
+			bvh->root = idx_b;
+		}
+
+		if(d->height > e->height)
+		{
+			b->child_1 = idx_d;
+			a->child_0 = idx_e;
+			e->parent = idx_a;
+		}
+		else
+		{
+			b->child_1 = idx_e;
+			a->child_0 = idx_d;
+			d->parent = idx_a;
+		}
+		bvh_node_refit(bvh, idx_a);
+		bvh_node_refit(bvh, idx_b);
+
+		return idx_b;
+	}
+
+	return idx_a;
+}
+
+// walks from the given node up to the root, rebalancing and refitting every node on the way
+static void bvh_refit_ancestors(BVH* bvh, int node_idx)
+{
+	while(node_idx != ITU_LIB_BVH_NULL_NODE)
+	{
+		node_idx = bvh_balance(bvh, node_idx);
+		bvh_node_refit(bvh, node_idx);
+		node_idx = bvh->nodes[node_idx].parent;
+	}
+}
+
+static void bvh_insert_leaf(BVH* bvh, int leaf)
+{
+	if(bvh->root == ITU_LIB_BVH_NULL_NODE)
+	{
+		bvh->root = leaf;
+		bvh->nodes[leaf].parent = ITU_LIB_BVH_NULL_NODE;
+		return;
+	}
+
+	vec2f leaf_min = bvh->nodes[leaf].aabb_min;
+	vec2f leaf_max = bvh->nodes[leaf].aabb_max;
+
+	// find the best sibling, going down the tree following the cheapest child (surface area heuristic)
+	int idx = bvh->root;
+	while(!bvh_node_is_leaf(&bvh->nodes[idx]))
+	{
+		BVHNode* node = &bvh->nodes[idx];
+
+		vec2f combined_min = vec2f{ SDL_min(node->aabb_min.x, leaf_min.x), SDL_min(node->aabb_min.y, leaf_min.y) };
+		vec2f combined_max = vec2f{ SDL_max(node->aabb_max.x, leaf_max.x), SDL_max(node->aabb_max.y, leaf_max.y) };
+		float area          = bvh_aabb_perimeter(node->aabb_min, node->aabb_max);
+		float area_combined = bvh_aabb_perimeter(combined_min, combined_max);
+
+		// cost of creating a new parent for this node and the new leaf
+		float cost = 2 * area_combined;
+
+		// minimum cost of pushing the leaf further down the tree
+		float cost_inheritance = 2 * (area_combined - area);
+
+		float cost_children[2];
+		int   children[2] = { node->child_0, node->child_1 };
+		for(int i = 0; i < 2; ++i)
+		{
+			BVHNode* child = &bvh->nodes[children[i]];
+			vec2f child_min = vec2f{ SDL_min(child->aabb_min.x, leaf_min.x), SDL_min(child->aabb_min.y, leaf_min.y) };
+			vec2f child_max = vec2f{ SDL_max(child->aabb_max.x, leaf_max.x), SDL_max(child->aabb_max.y, leaf_max.y) };
+			float child_area_combined = bvh_aabb_perimeter(child_min, child_max);
+
+			if(bvh_node_is_leaf(child))
+				cost_children[i] = child_area_combined + cost_inheritance;
+			else
+				cost_children[i] = (child_area_combined - bvh_aabb_perimeter(child->aabb_min, child->aabb_max)) + cost_inheritance;
+		}
+
+		if(cost < cost_children[0] && cost < cost_children[1])
+			break;
+
+		idx = cost_children[0] < cost_children[1] ? children[0] : children[1];
+	}
+
+	int sibling = idx;
+
+	// create a new parent for the leaf and its sibling
+	// NOTE: no pointers to nodes before this point, allocating may move the whole pool
+	int parent_old = bvh->nodes[sibling].parent;
+	int parent_new = bvh_node_alloc(bvh);
+	bvh->nodes[parent_new].parent  = parent_old;
+	bvh->nodes[parent_new].child_0 = sibling;
+	bvh->nodes[parent_new].child_1 = leaf;
+	bvh->nodes[sibling].parent = parent_new;
+	bvh->nodes[leaf].parent    = parent_new;
+
+	if(parent_old != ITU_LIB_BVH_NULL_NODE)
+	{
+		if(bvh->nodes[parent_old].child_0 == sibling)
+			bvh->nodes[parent_old].child_0 = parent_new;
+		else
+			bvh->nodes[parent_old].child_1 = parent_new;
+	}
+	else
+	{
+		bvh->root = parent_new;
+	}
+
+	bvh_refit_ancestors(bvh, parent_new);
+}
+
+static void bvh_remove_leaf(BVH* bvh, int leaf)
+{
+	if(leaf == bvh->root)
+	{
+		bvh->root = ITU_LIB_BVH_NULL_NODE;
+		return;
+	}
+
+	int parent      = bvh->nodes[leaf].parent;
+	int grandparent = bvh->nodes[parent].parent;
+	int sibling     = bvh->nodes[parent].child_0 == leaf ? bvh->nodes[parent].child_1 : bvh->nodes[parent].child_0;
+
+	// the sibling takes the place of the parent
+	if(grandparent != ITU_LIB_BVH_NULL_NODE)
+	{
+		if(bvh->nodes[grandparent].child_0 == parent)
+			bvh->nodes[grandparent].child_0 = sibling;
+		else
+			bvh->nodes[grandparent].child_1 = sibling;
+		bvh->nodes[sibling].parent = grandparent;
+		bvh_node_free(bvh, parent);
+
+		bvh_refit_ancestors(bvh, grandparent);
+	}
+	else
+	{
+		bvh->root = sibling;
+		bvh->nodes[sibling].parent = ITU_LIB_BVH_NULL_NODE;
+		bvh_node_free(bvh, parent);
+	}
+}
+
+// computes the fat AABB of the given shape
+static void bvh_get_fat_aabb(BVH* bvh, Shape* shape, vec2f* out_min, vec2f* out_max)
+{
+	itu_lib_overlaps_shape_get_aabb(shape, out_min, out_max);
+	*out_min = *out_min - bvh->margin;
+	*out_max = *out_max + bvh->margin;
+}
+
+void itu_lib_bvh_init(BVH* bvh, float margin, int nodes_capacity)
+{
+	SDL_assert(bvh);
+	SDL_assert(margin >= 0);
+
+	*bvh = BVH{ };
+	bvh->root      = ITU_LIB_BVH_NULL_NODE;
+	bvh->free_list = ITU_LIB_BVH_NULL_NODE;
+	bvh->margin    = margin;
+
+	// NOTE: a tree with N leaves has N-1 internal nodes, so 2*leaves is a good guess
+	if(nodes_capacity > 0)
+	{
+		bvh->nodes = (BVHNode*)SDL_realloc(NULL, nodes_capacity * sizeof(BVHNode));
+		SDL_assert(bvh->nodes);
+		bvh->nodes_capacity = nodes_capacity;
+		itu_lib_bvh_clear(bvh);
+	}
+}
+
+void itu_lib_bvh_deinit(BVH* bvh)
+{
+	SDL_free(bvh->nodes);
+	SDL_free(bvh->stack);
+	*bvh = BVH{ };
+}
+
+// removes all leaves (keeping the allocated memory)
+void itu_lib_bvh_clear(BVH* bvh)
+{
+	for(int i = 0; i < bvh->nodes_capacity; ++i)
+	{
+		bvh->nodes[i].parent = i + 1 < bvh->nodes_capacity ? i + 1 : ITU_LIB_BVH_NULL_NODE;
+		bvh->nodes[i].height = -1;
+	}
+	bvh->free_list   = bvh->nodes_capacity > 0 ? 0 : ITU_LIB_BVH_NULL_NODE;
+	bvh->root        = ITU_LIB_BVH_NULL_NODE;
+	bvh->nodes_count = 0;
+}
+
+// adds a new leaf to the tree, returns its index (needed to move or remove it later)
+int itu_lib_bvh_insert(BVH* bvh, Shape* shape, Uint32 user_id)
+{
+	int leaf = bvh_node_alloc(bvh);
+
+	BVHNode* node = &bvh->nodes[leaf];
+	node->shape   = *shape;
+	node->user_id = user_id;
+	bvh_get_fat_aabb(bvh, shape, &node->aabb_min, &node->aabb_max);
+
+	bvh_insert_leaf(bvh, leaf);
+	return leaf;
+}
+
+void itu_lib_bvh_remove(BVH* bvh, int leaf)
+{
+	SDL_assert(leaf >= 0 && leaf < bvh->nodes_capacity);
+	SDL_assert(bvh_node_is_leaf(&bvh->nodes[leaf]));
+
+	bvh_remove_leaf(bvh, leaf);
+	bvh_node_free(bvh, leaf);
+}
+
+// updates the shape stored in the leaf
+// if the shape is still inside the leaf's fat AABB the tree is not touched at all, otherwise the leaf gets reinserted
+// returns true if the tree was modified
+bool itu_lib_bvh_move(BVH* bvh, int leaf, Shape* shape)
+{
+	SDL_assert(leaf >= 0 && leaf < bvh->nodes_capacity);
+	SDL_assert(bvh_node_is_leaf(&bvh->nodes[leaf]));
+
+	BVHNode* node = &bvh->nodes[leaf];
+	node->shape = *shape;
+
+	vec2f aabb_min, aabb_max;
+	itu_lib_overlaps_shape_get_aabb(shape, &aabb_min, &aabb_max);
+	if(bvh_aabb_contains(node->aabb_min, node->aabb_max, aabb_min, aabb_max))
+		return false;
+
+	bvh_remove_leaf(bvh, leaf);
+	bvh_get_fat_aabb(bvh, shape, &node->aabb_min, &node->aabb_max);
+	bvh_insert_leaf(bvh, leaf);
+	return true;
+}
+
+// changes the layer and mask of the leaf (and the ORs of all its ancestors)
+void itu_lib_bvh_set_filter(BVH* bvh, int leaf, Uint32 layer, Uint32 mask)
+{
+	SDL_assert(leaf >= 0 && leaf < bvh->nodes_capacity);
+	SDL_assert(bvh_node_is_leaf(&bvh->nodes[leaf]));
+
+	bvh->nodes[leaf].layers = layer;
+	bvh->nodes[leaf].masks  = mask;
+
+	// NOTE: bits can also be removed, so ancestors are recomputed from their children instead of just OR-ing the new ones.
+	//       The shape of the tree doesn't change, no need to rebalance
+	for(int idx = bvh->nodes[leaf].parent; idx != ITU_LIB_BVH_NULL_NODE; idx = bvh->nodes[idx].parent)
+		bvh_node_refit(bvh, idx);
+}
+
+int itu_lib_bvh_get_height(BVH* bvh)
+{
+	if(bvh->root == ITU_LIB_BVH_NULL_NODE)
+		return 0;
+	return bvh->nodes[bvh->root].height;
+}
+
+// reports all leaves whose fat AABB overlaps the given AABB, and whose layer is in `mask`
+void itu_lib_bvh_query_aabb(BVH* bvh, vec2f aabb_min, vec2f aabb_max, Uint32 mask, BVHQueryCallback callback, void* userdata)
+{
+	if(bvh->root == ITU_LIB_BVH_NULL_NODE)
+		return;
+
+	int stack_count = 0;
+	bvh_stack_push(bvh, &stack_count, bvh->root);
+	while(stack_count > 0)
+	{
+		BVHNode* node = &bvh->nodes[bvh->stack[--stack_count]];
+		if(!(node->layers & mask) || !itu_lib_overlaps_rect_rect(node->aabb_min, node->aabb_max, aabb_min, aabb_max))
+			continue;
+
+		if(bvh_node_is_leaf(node))
+		{
+			if(!callback(userdata, node->user_id))
+				return;
+			continue;
+		}
+
+		int child_0 = node->child_0;
+		int child_1 = node->child_1;
+		bvh_stack_push(bvh, &stack_count, child_1);
+		bvh_stack_push(bvh, &stack_count, child_0);
+	}
+}
+
+// reports every pair of compatible leaves (in the same tree) whose fat AABBs overlap, each pair exactly once
+// NOTE: instead of querying the tree once per leaf, we descend the tree against itself: the pairs of a subtree are
+//       the pairs of its left child, plus the pairs of its right child, plus the pairs between left and right.
+//       The stack holds pairs of nodes, where a pair of the same node means "all pairs inside this subtree"
+void itu_lib_bvh_query_pairs(BVH* bvh, BVHPairCallback callback, void* userdata)
+{
+	if(bvh->root == ITU_LIB_BVH_NULL_NODE)
+		return;
+
+	int stack_count = 0;
+	bvh_stack_push(bvh, &stack_count, bvh->root);
+	bvh_stack_push(bvh, &stack_count, bvh->root);
+	while(stack_count > 0)
+	{
+		// NOTE: nodes never move during a query (only the stack can be reallocated), so pointers are safe here
+		int idx_b = bvh->stack[--stack_count];
+		int idx_a = bvh->stack[--stack_count];
+		BVHNode* a = &bvh->nodes[idx_a];
+		BVHNode* b = &bvh->nodes[idx_b];
+
+		if(idx_a == idx_b)
+		{
+			if(bvh_node_is_leaf(a) || !bvh_filters_match(a, a))
+				continue;
+
+			bvh_stack_push(bvh, &stack_count, a->child_0);
+			bvh_stack_push(bvh, &stack_count, a->child_1);
+			bvh_stack_push(bvh, &stack_count, a->child_1);
+			bvh_stack_push(bvh, &stack_count, a->child_1);
+			bvh_stack_push(bvh, &stack_count, a->child_0);
+			bvh_stack_push(bvh, &stack_count, a->child_0);
+			continue;
+		}
+
+		if(!bvh_filters_match(a, b) || !bvh_aabb_overlaps(a, b))
+			continue;
+
+		bool a_is_leaf = bvh_node_is_leaf(a);
+		bool b_is_leaf = bvh_node_is_leaf(b);
+		if(a_is_leaf && b_is_leaf)
+		{
+			if(!callback(userdata, a->user_id, b->user_id))
+				return;
+		}
+		// descend into the bigger node first
+		else if(b_is_leaf || (!a_is_leaf && a->height >= b->height))
+		{
+			bvh_stack_push(bvh, &stack_count, a->child_1);
+			bvh_stack_push(bvh, &stack_count, idx_b);
+			bvh_stack_push(bvh, &stack_count, a->child_0);
+			bvh_stack_push(bvh, &stack_count, idx_b);
+		}
+		else
+		{
+			bvh_stack_push(bvh, &stack_count, idx_a);
+			bvh_stack_push(bvh, &stack_count, b->child_1);
+			bvh_stack_push(bvh, &stack_count, idx_a);
+			bvh_stack_push(bvh, &stack_count, b->child_0);
+		}
+	}
+}
+
+// reports every pair of compatible leaves (one from each tree) whose fat AABBs overlap
+// the first id passed to the callback always comes from `bvh_0`
+void itu_lib_bvh_query_pairs_tree(BVH* bvh_0, BVH* bvh_1, BVHPairCallback callback, void* userdata)
+{
+	if(bvh_0->root == ITU_LIB_BVH_NULL_NODE || bvh_1->root == ITU_LIB_BVH_NULL_NODE)
+		return;
+
+	// NOTE: the stack of the first tree holds the pairs (first index in bvh_0, second index in bvh_1)
+	int stack_count = 0;
+	bvh_stack_push(bvh_0, &stack_count, bvh_0->root);
+	bvh_stack_push(bvh_0, &stack_count, bvh_1->root);
+	while(stack_count > 0)
+	{
+		int idx_b = bvh_0->stack[--stack_count];
+		int idx_a = bvh_0->stack[--stack_count];
+		BVHNode* a = &bvh_0->nodes[idx_a];
+		BVHNode* b = &bvh_1->nodes[idx_b];
+
+		if(!bvh_filters_match(a, b) || !bvh_aabb_overlaps(a, b))
+			continue;
+
+		bool a_is_leaf = bvh_node_is_leaf(a);
+		bool b_is_leaf = bvh_node_is_leaf(b);
+		if(a_is_leaf && b_is_leaf)
+		{
+			if(!callback(userdata, a->user_id, b->user_id))
+				return;
+		}
+		else if(b_is_leaf || (!a_is_leaf && a->height >= b->height))
+		{
+			bvh_stack_push(bvh_0, &stack_count, a->child_1);
+			bvh_stack_push(bvh_0, &stack_count, idx_b);
+			bvh_stack_push(bvh_0, &stack_count, a->child_0);
+			bvh_stack_push(bvh_0, &stack_count, idx_b);
+		}
+		else
+		{
+			bvh_stack_push(bvh_0, &stack_count, idx_a);
+			bvh_stack_push(bvh_0, &stack_count, b->child_1);
+			bvh_stack_push(bvh_0, &stack_count, idx_a);
+			bvh_stack_push(bvh_0, &stack_count, b->child_0);
+		}
+	}
+}
+
+// precomputed data of a ray, for the slab tests against the node AABBs
+struct BVHRay
+{
+	vec2f a;
+	vec2f d;
+	vec2f d_inv; // 1/d, 0 on axes where the ray doesn't move
+};
+
+static inline BVHRay bvh_ray_make(vec2f ray_a, vec2f ray_b)
+{
+	BVHRay ret;
+	ret.a = ray_a;
+	ret.d = ray_b - ray_a;
+	ret.d_inv.x = ret.d.x != 0 ? 1.0f / ret.d.x : 0;
+	ret.d_inv.y = ret.d.y != 0 ? 1.0f / ret.d.y : 0;
+	return ret;
+}
+
+// slab test of the ray (only up to `t_max`) against the AABB of a node, `out_t_enter` gets where the ray enters it
+// NOTE: unlike `itu_lib_sweep_segment_rect()`, this is inclusive. A ray grazing a fat AABB can still hit the shape inside
+static inline bool bvh_ray_aabb(BVHRay* ray, float t_max, BVHNode* node, float* out_t_enter)
+{
+	float t_enter = 0;
+	float t_exit  = t_max;
+
+	float a[2]     = { ray->a.x, ray->a.y };
+	float d[2]     = { ray->d.x, ray->d.y };
+	float d_inv[2] = { ray->d_inv.x, ray->d_inv.y };
+	float min[2]   = { node->aabb_min.x, node->aabb_min.y };
+	float max[2]   = { node->aabb_max.x, node->aabb_max.y };
+	for(int axis = 0; axis < 2; ++axis)
+	{
+		if(d[axis] == 0)
+		{
+			if(a[axis] < min[axis] || a[axis] > max[axis])
+				return false;
+			continue;
+		}
+
+		float t_0 = (min[axis] - a[axis]) * d_inv[axis];
+		float t_1 = (max[axis] - a[axis]) * d_inv[axis];
+		t_enter = SDL_max(t_enter, SDL_min(t_0, t_1));
+		t_exit  = SDL_min(t_exit,  SDL_max(t_0, t_1));
+	}
+
+	*out_t_enter = t_enter;
+	return t_enter <= t_exit;
+}
+
+// pushes the children of `node` so that the one closer to the ray start is popped first
+static inline void bvh_stack_push_children_sorted(BVH* bvh, int* stack_count, BVHNode* node, vec2f ray_d)
+{
+	BVHNode* child_0 = &bvh->nodes[node->child_0];
+	BVHNode* child_1 = &bvh->nodes[node->child_1];
+	float t_0 = dot(child_0->aabb_min + child_0->aabb_max, ray_d);
+	float t_1 = dot(child_1->aabb_min + child_1->aabb_max, ray_d);
+
+	int child_0_idx = node->child_0;
+	int child_1_idx = node->child_1;
+	if(t_0 <= t_1)
+	{
+		bvh_stack_push(bvh, stack_count, child_1_idx);
+		bvh_stack_push(bvh, stack_count, child_0_idx);
+	}
+	else
+	{
+		bvh_stack_push(bvh, stack_count, child_0_idx);
+		bvh_stack_push(bvh, stack_count, child_1_idx);
+	}
+}
+
+// finds the first shape hit by the segment ray_a-ray_b
+// NOTE: closer children are visited first, and nodes that start after the closest hit so far are skipped entirely
+bool itu_lib_bvh_raycast(BVH* bvh, vec2f ray_a, vec2f ray_b, BVHRaycastHit* out_hit)
+{
+	SDL_assert(out_hit);
+
+	out_hit->leaf = ITU_LIB_BVH_NULL_NODE;
+	out_hit->toi  = 1;
+	if(bvh->root == ITU_LIB_BVH_NULL_NODE)
+		return false;
+
+	BVHRay ray = bvh_ray_make(ray_a, ray_b);
+
+	int stack_count = 0;
+	bvh_stack_push(bvh, &stack_count, bvh->root);
+	while(stack_count > 0)
+	{
+		int node_idx = bvh->stack[--stack_count];
+		BVHNode* node = &bvh->nodes[node_idx];
+
+		float t_enter;
+		if(!bvh_ray_aabb(&ray, out_hit->toi, node, &t_enter))
+			continue;
+
+		if(bvh_node_is_leaf(node))
+		{
+			float toi;
+			vec2f normal;
+			if(itu_lib_sweep_segment_shape(ray_a, ray_b, &node->shape, &toi, &normal) && (toi < out_hit->toi || out_hit->leaf == ITU_LIB_BVH_NULL_NODE))
+			{
+				out_hit->leaf    = node_idx;
+				out_hit->user_id = node->user_id;
+				out_hit->toi     = toi;
+				out_hit->normal  = normal;
+			}
+			continue;
+		}
+
+		bvh_stack_push_children_sorted(bvh, &stack_count, node, ray.d);
+	}
+
+	return out_hit->leaf != ITU_LIB_BVH_NULL_NODE;
+}
+
+// finds all shapes hit by the segment ray_a-ray_b, sorted by `toi`
+// returns the number of hits written in `out_hits`. If there are more than `out_hits_capacity`, only the closest ones are kept
+int itu_lib_bvh_raycast_all(BVH* bvh, vec2f ray_a, vec2f ray_b, BVHRaycastHit* out_hits, int out_hits_capacity)
+{
+	SDL_assert(out_hits || out_hits_capacity == 0);
+
+	if(bvh->root == ITU_LIB_BVH_NULL_NODE || out_hits_capacity <= 0)
+		return 0;
+
+	BVHRay ray = bvh_ray_make(ray_a, ray_b);
+	int hits_count = 0;
+
+	int stack_count = 0;
+	bvh_stack_push(bvh, &stack_count, bvh->root);
+	while(stack_count > 0)
+	{
+		int node_idx = bvh->stack[--stack_count];
+		BVHNode* node = &bvh->nodes[node_idx];
+
+		// NOTE: once the hits buffer is full, anything farther than the last hit would be dropped anyway
+		float t_max = hits_count == out_hits_capacity ? out_hits[hits_count - 1].toi : 1;
+		float t_enter;
+		if(!bvh_ray_aabb(&ray, t_max, node, &t_enter))
+			continue;
+
+		if(!bvh_node_is_leaf(node))
+		{
+			bvh_stack_push_children_sorted(bvh, &stack_count, node, ray.d);
+			continue;
+		}
+
+		BVHRaycastHit hit;
+		if(!itu_lib_sweep_segment_shape(ray_a, ray_b, &node->shape, &hit.toi, &hit.normal))
+			continue;
+		hit.leaf    = node_idx;
+		hit.user_id = node->user_id;
+
+		// insertion sort (there are usually only a few hits per ray), when full the farthest hit gets dropped
+		if(hits_count < out_hits_capacity)
+			hits_count++;
+		else if(out_hits[hits_count - 1].toi <= hit.toi)
+			continue;
+
+		int i = hits_count - 1;
+		while(i > 0 && out_hits[i - 1].toi > hit.toi)
+		{
+			out_hits[i] = out_hits[i - 1];
+			--i;
+		}
+		out_hits[i] = hit;
+	}
+
+	return hits_count;
+}
+
+// same as calling `itu_lib_bvh_raycast()` for each ray (one result per ray in `out_hits`), returns the number of rays that hit something
+// NOTE: rays are processed in packets of `ITU_LIB_BVH_RAYCAST_PACKET_SIZE`, that walk down the tree together: each node is
+//       fetched once per packet instead of once per ray, and only the rays still hitting its AABB go on to the children.
+//       This works best with coherent rays (ie, line of sight checks from the same point, or a shotgun blast),
+//       so keep rays that are close to each other also close in the input arrays
+int itu_lib_bvh_raycast_batch(BVH* bvh, vec2f* rays_a, vec2f* rays_b, int rays_count, BVHRaycastHit* out_hits)
+{
+	SDL_assert(rays_count == 0 || (rays_a && rays_b && out_hits));
+
+	for(int i = 0; i < rays_count; ++i)
+	{
+		out_hits[i].leaf = ITU_LIB_BVH_NULL_NODE;
+		out_hits[i].toi  = 1;
+	}
+	if(bvh->root == ITU_LIB_BVH_NULL_NODE)
+		return 0;
+
+	int hits_count = 0;
+	BVHRay rays[ITU_LIB_BVH_RAYCAST_PACKET_SIZE];
+	for(int packet_beg = 0; packet_beg < rays_count; packet_beg += ITU_LIB_BVH_RAYCAST_PACKET_SIZE)
+	{
+		int packet_count = SDL_min(rays_count - packet_beg, ITU_LIB_BVH_RAYCAST_PACKET_SIZE);
+		BVHRaycastHit* packet_hits = out_hits + packet_beg;
+
+		// NOTE: children are sorted along the average direction of the packet
+		vec2f packet_d = VEC2F_ZERO;
+		for(int i = 0; i < packet_count; ++i)
+		{
+			rays[i] = bvh_ray_make(rays_a[packet_beg + i], rays_b[packet_beg + i]);
+			packet_d += rays[i].d;
+		}
+
+		// the stack holds pairs of (node, mask of the rays still active in that node)
+		Uint32 packet_mask = packet_count == 32 ? SDL_MAX_UINT32 : (1u << packet_count) - 1;
+		int stack_count = 0;
+		bvh_stack_push(bvh, &stack_count, bvh->root);
+		bvh_stack_push(bvh, &stack_count, (int)packet_mask);
+		while(stack_count > 0)
+		{
+			Uint32 mask = (Uint32)bvh->stack[--stack_count];
+			int node_idx = bvh->stack[--stack_count];
+			BVHNode* node = &bvh->nodes[node_idx];
+
+			Uint32 mask_hit = 0;
+			for(int i = 0; i < packet_count; ++i)
+			{
+				float t_enter;
+				if((mask & (1u << i)) && bvh_ray_aabb(&rays[i], packet_hits[i].toi, node, &t_enter))
+					mask_hit |= 1u << i;
+			}
+			if(mask_hit == 0)
+				continue;
+
+			if(bvh_node_is_leaf(node))
+			{
+				for(int i = 0; i < packet_count; ++i)
+				{
+					if(!(mask_hit & (1u << i)))
+						continue;
+
+					BVHRaycastHit* hit = &packet_hits[i];
+					float toi;
+					vec2f normal;
+					if(itu_lib_sweep_segment_shape(rays[i].a, rays[i].a + rays[i].d, &node->shape, &toi, &normal) && (toi < hit->toi || hit->leaf == ITU_LIB_BVH_NULL_NODE))
+					{
+						hit->leaf    = node_idx;
+						hit->user_id = node->user_id;
+						hit->toi     = toi;
+						hit->normal  = normal;
+					}
+				}
+				continue;
+			}
+
+			BVHNode* child_0 = &bvh->nodes[node->child_0];
+			BVHNode* child_1 = &bvh->nodes[node->child_1];
+			int child_near = node->child_0;
+			int child_far  = node->child_1;
+			if(dot(child_0->aabb_min + child_0->aabb_max, packet_d) > dot(child_1->aabb_min + child_1->aabb_max, packet_d))
+			{
+				child_near = node->child_1;
+				child_far  = node->child_0;
+			}
+			bvh_stack_push(bvh, &stack_count, child_far);
+			bvh_stack_push(bvh, &stack_count, (int)mask_hit);
+			bvh_stack_push(bvh, &stack_count, child_near);
+			bvh_stack_push(bvh, &stack_count, (int)mask_hit);
+		}
+
+		for(int i = 0; i < packet_count; ++i)
+			if(packet_hits[i].leaf != ITU_LIB_BVH_NULL_NODE)
+				hits_count++;
+	}
+
+	return hits_count;
+}
+
+#endif // ITU_LIB_BVH_IMPLEMENTATION
+
+#endif // ITU_LIB_BVH_HPP
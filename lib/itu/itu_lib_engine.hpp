@@ -10,6 +10,10 @@
 #include <stb_image.h>
 #include <itu_common.hpp>
 
+// fixed timestep defaults (see `sdl_timestep_init()`)
+#define ITU_ENGINE_SIM_HZ_DEFAULT        60
+#define ITU_ENGINE_SIM_STEPS_MAX_DEFAULT 5
+
 enum BtnType
 {
 	BTN_TYPE_UP,
@@ -51,6 +55,22 @@ struct SDLContext
 	float delta;    // in seconds
 	float uptime;   // in seconds
 
+	// fixed timestep
+	// the simulation advances in steps of `sim_delta` seconds, no matter how long frames take:
+	// - at the beginning of the frame, call `sdl_timestep_accumulate()` with the duration of the last frame
+	// - then call the fixed update `while(sdl_timestep_step(context))`. Inside it, use `sim_delta` instead of `delta`
+	// - render interpolating between the previous and current state of the simulation by `sim_alpha` (see `transform_interpolate()`)
+	// NOTE: if the simulation falls behind by more than `sim_steps_max` steps the remaining time is dropped (the game slows down),
+	//       otherwise a slow frame leads to more steps, which lead to a slower frame, and so on
+	// NOTE: a frame may run zero steps (ie, rendering faster than `sim_hz`), so per-frame input (`btn_isjustpressed`, `mouse_scroll`)
+	//       should be read outside of the fixed update
+	SDL_Time sim_step;        // in nanoseconds
+	SDL_Time sim_accumulator; // in nanoseconds, time not simulated yet
+	float    sim_delta;       // in seconds, `sim_step` as a float
+	int      sim_steps_max;   // max steps per frame
+	int      sim_steps;       // steps taken in the current frame
+	float    sim_alpha;       // in [0, 1), how far the render is between the previous and the current step
+
 	Camera* camera_active;
 	Camera camera_default; // default camera
 
@@ -96,6 +116,10 @@ void sdl_input_key_process(SDLContext* context, BtnType button_id, SDL_Event* ev
 SDL_Texture* texture_create(SDLContext* context, const char* path, SDL_ScaleMode mode);
 void sdl_set_render_draw_color(SDLContext* context, color c);
 void sdl_set_texture_tint(SDL_Texture* texture, color c);
+void sdl_timestep_init(SDLContext* context, int sim_hz, int steps_max);
+void sdl_timestep_accumulate(SDLContext* context, SDL_Time elapsed);
+bool sdl_timestep_step(SDLContext* context);
+Transform transform_interpolate(Transform* previous, Transform* current, float alpha);
 
 #if (defined ITU_LIB_ENGINE_IMPLEMENTATION) || (defined ITU_UNITY_BUILD)
 
@@ -255,6 +279,61 @@ void sdl_set_texture_tint(SDL_Texture* texture, color c)
 	SDL_SetTextureAlphaModFloat(texture, c.a);
 }
 
+// sets the simulation rate, and drops any time accumulated so far
+void sdl_timestep_init(SDLContext* context, int sim_hz, int steps_max)
+{
+	SDL_assert(context);
+	SDL_assert(sim_hz > 0 && steps_max > 0);
+
+	context->sim_step        = SECONDS(1) / sim_hz;
+	context->sim_delta       = NS_TO_SECONDS(context->sim_step);
+	context->sim_steps_max   = steps_max;
+	context->sim_steps       = 0;
+	context->sim_accumulator = 0;
+	context->sim_alpha       = 0;
+}
+
+// adds the duration of the last frame (in nanoseconds) to the time to simulate
+void sdl_timestep_accumulate(SDLContext* context, SDL_Time elapsed)
+{
+	SDL_assert(context && context->sim_step > 0);
+
+	context->sim_accumulator += SDL_max(elapsed, 0);
+	context->sim_steps = 0;
+}
+
+// returns true if there is a step to simulate (consuming it), false when the simulation caught up.
+// After the last step, `sim_alpha` is updated with the time left over
+bool sdl_timestep_step(SDLContext* context)
+{
+	SDL_assert(context && context->sim_step > 0);
+
+	if(context->sim_accumulator >= context->sim_step && context->sim_steps < context->sim_steps_max)
+	{
+		context->sim_accumulator -= context->sim_step;
+		context->sim_steps++;
+		return true;
+	}
+
+	// NOTE: only whole steps are dropped, so the render stays where it would have been
+	if(context->sim_accumulator >= context->sim_step)
+		context->sim_accumulator %= context->sim_step;
+
+	context->sim_alpha = (float)context->sim_accumulator / (float)context->sim_step;
+	return false;
+}
+
+// returns the transform `alpha` of the way from `previous` to `current`
+// NOTE: rotation is interpolated linearly, it doesn't take the short way around (big rotations in a single step will spin the wrong way)
+Transform transform_interpolate(Transform* previous, Transform* current, float alpha)
+{
+	Transform ret;
+	ret.position = previous->position + (current->position - previous->position) * alpha;
+	ret.scale    = previous->scale    + (current->scale    - previous->scale)    * alpha;
+	ret.rotation = previous->rotation + (current->rotation - previous->rotation) * alpha;
+	return ret;
+}
+
 #endif // ITU_LIB_ENGINE_IMPLEMENTATION
 
 #endif // ITU_LIB_ENGINE_HPP
\ No newline at end of file
@@ -0,0 +1,159 @@
+// itu_lib_jobs.hpp
+// minimal thread pool built on SDL threads, to run "parallel for" loops
+//
+// usage:
+// - split the work in jobs, each job identified by its index
+// - call `itu_lib_jobs_parallel_for()`, which returns only when all jobs are done
+// - the calling thread works on jobs too, so a pool with 0 active threads just runs everything serially
+//
+// important notes:
+// - jobs are grabbed by whichever thread is free, so the job<>thread assignment changes every time.
+//   If the results must not depend on the number of threads, write them per job (not per thread) and merge them in job order
+// - `thread_idx` is unique among threads running at the same time (0 is the calling thread),
+//   use it to index per-thread scratch memory
+// - only one thread at a time should call `itu_lib_jobs_parallel_for()` on the same pool
+//
+// SDL functions used here:
+// - SDL_CreateThread()
+// - SDL_WaitThread()
+// - SDL_CreateSemaphore(), SDL_DestroySemaphore(), SDL_WaitSemaphore(), SDL_SignalSemaphore()
+// - SDL_AddAtomicInt(), SDL_SetAtomicInt()
+
+#ifndef ITU_LIB_JOBS_HPP
+#define ITU_LIB_JOBS_HPP
+
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_atomic.h>
+#include <itu_common.hpp>
+
+#define ITU_LIB_JOBS_THREADS_MAX 64
+
+typedef void (*JobFunction)(void* userdata, int job_idx, int thread_idx);
+
+struct JobPool;
+
+struct JobWorker
+{
+	JobPool*    pool;
+	SDL_Thread* thread;
+	int         thread_idx;
+};
+
+struct JobPool
+{
+	JobWorker workers[ITU_LIB_JOBS_THREADS_MAX];
+	int       workers_count;  // worker threads created at init
+	int       workers_active; // worker threads used by `itu_lib_jobs_parallel_for()`, can be changed between calls
+
+	SDL_Semaphore* semaphore_start;
+	SDL_Semaphore* semaphore_done;
+
+	// current batch of jobs
+	SDL_AtomicInt job_next;
+	int           jobs_count;
+	JobFunction   function;
+	void*         userdata;
+	bool          quit;
+};
+
+void itu_lib_jobs_init(JobPool* pool, int workers_count);
+void itu_lib_jobs_deinit(JobPool* pool);
+void itu_lib_jobs_parallel_for(JobPool* pool, int jobs_count, JobFunction function, void* userdata);
+
+#if defined ITU_LIB_JOBS_IMPLEMENTATION || defined ITU_UNITY_BUILD
+
+static void jobs_work(JobPool* pool, int thread_idx)
+{
+	for(;;)
+	{
+		int job_idx = SDL_AddAtomicInt(&pool->job_next, 1);
+		if(job_idx >= pool->jobs_count)
+			break;
+
+		pool->function(pool->userdata, job_idx, thread_idx);
+	}
+}
+
+static int jobs_worker_main(void* data)
+{
+	JobWorker* worker = (JobWorker*)data;
+	JobPool*   pool   = worker->pool;
+
+	for(;;)
+	{
+		SDL_WaitSemaphore(pool->semaphore_start);
+		if(pool->quit)
+			break;
+
+		jobs_work(pool, worker->thread_idx);
+		SDL_SignalSemaphore(pool->semaphore_done);
+	}
+
+	return 0;
+}
+
+// creates `workers_count` threads (clamped to `ITU_LIB_JOBS_THREADS_MAX - 1`), all of them active by default
+// NOTE: the calling thread works too, so `SDL_GetNumLogicalCPUCores() - 1` is usually a good number
+void itu_lib_jobs_init(JobPool* pool, int workers_count)
+{
+	SDL_assert(pool);
+
+	*pool = JobPool{ };
+	pool->workers_count  = SDL_clamp(workers_count, 0, ITU_LIB_JOBS_THREADS_MAX - 1);
+	pool->workers_active = pool->workers_count;
+
+	pool->semaphore_start = SDL_CreateSemaphore(0);
+	pool->semaphore_done  = SDL_CreateSemaphore(0);
+	VALIDATE_PANIC(pool->semaphore_start && pool->semaphore_done);
+
+	for(int i = 0; i < pool->workers_count; ++i)
+	{
+		JobWorker* worker = &pool->workers[i];
+		worker->pool       = pool;
+		worker->thread_idx = i + 1; // 0 is the calling thread
+		worker->thread     = SDL_CreateThread(jobs_worker_main, "itu_lib_jobs_worker", worker);
+		VALIDATE_PANIC(worker->thread);
+	}
+}
+
+void itu_lib_jobs_deinit(JobPool* pool)
+{
+	pool->quit = true;
+	for(int i = 0; i < pool->workers_count; ++i)
+		SDL_SignalSemaphore(pool->semaphore_start);
+	for(int i = 0; i < pool->workers_count; ++i)
+		SDL_WaitThread(pool->workers[i].thread, NULL);
+
+	SDL_DestroySemaphore(pool->semaphore_start);
+	SDL_DestroySemaphore(pool->semaphore_done);
+	*pool = JobPool{ };
+}
+
+// runs `function` once for every job index in [0, jobs_count), returns when all of them are done
+void itu_lib_jobs_parallel_for(JobPool* pool, int jobs_count, JobFunction function, void* userdata)
+{
+	if(jobs_count <= 0)
+		return;
+
+	int workers = SDL_clamp(pool->workers_active, 0, pool->workers_count);
+	workers = SDL_min(workers, jobs_count - 1);
+
+	pool->jobs_count = jobs_count;
+	pool->function   = function;
+	pool->userdata   = userdata;
+	SDL_SetAtomicInt(&pool->job_next, 0);
+
+	// wake up the workers, and get to work ourselves
+	for(int i = 0; i < workers; ++i)
+		SDL_SignalSemaphore(pool->semaphore_start);
+
+	jobs_work(pool, 0);
+
+	for(int i = 0; i < workers; ++i)
+		SDL_WaitSemaphore(pool->semaphore_done);
+}
+
+#endif // ITU_LIB_JOBS_IMPLEMENTATION
+
+#endif // ITU_LIB_JOBS_HPP
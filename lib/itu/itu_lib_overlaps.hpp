@@ -17,17 +17,37 @@
 //         a segment will reside in a different library)
 //       - parallel segments are not considering overlapping (see point above)
 // - polygons are assumed to be in CCW (counter-clockwise) order
-// - polygon methods use simple algorithms, so they won't scale to polygons with a lot of edges
+// - `OBB` (oriented rect) and capsules (segment "inflated" by a radius) have their own pair functions, which don't go through GJK.
+//   Capsule tests work on the capsule's core segment: closest points when the cores are apart, SAT (plus the radii) when they overlap
+// - polygon methods use simple algorithms, so they won't scale to polygons with a lot of edges.
+//   For those, use `ConvexPolygon` (edge normals, AABB and bounding circle computed once, O(log(N)) point test, O(N+M) SAT)
+// - `itu_lib_overlaps_circle_circles()` and `itu_lib_overlaps_segment_circles()` test one shape against many circles, stored in SoA layout (separate x, y and radius arrays).
+//   It uses AVX2 (if the cpu supports it), SSE2 or NEON, and falls back to plain scalar code everywhere else
+//   (define ITU_LIB_OVERLAPS_DISABLE_SIMD to always use the scalar code)
+// - `Shape` is a tagged union of circle, rect, capsule and polygon (each with its own transform), for code that needs to handle any of them
+//   (ie, the BVH in itu_lib_bvh.hpp). Shape pairs are all handled by the same GJK (overlap) and EPA (contact) code,
+//   which only needs each shape to provide a support function (see `itu_lib_overlaps_shape_support()`)
+// - `itu_lib_collide_*` functions do the same tests as their `itu_lib_overlaps_*` counterpart, but also fill a `Contact`
+//   with everything needed to separate the two shapes (so callers don't need to redo the math after a positive test)
+// - polygon pairs can get their contact in two ways: `itu_lib_collide_polygon_polygon()` (SAT, cheap for few edges) or
+//   `itu_lib_overlaps_polygon_polygon()` (GJK) followed by `itu_lib_collide_polygon_polygon_epa()` (EPA), which only relies on support points.
+//   The hand-written pair functions are still the fastest option when the shape types are known in advance
+// - `itu_lib_sweep_*` functions are the exception to the "instantaneous information only" rule: they take how much each shape moves
+//   during the step (ie, `velocity * delta`) and return the time of impact in [0, 1], so fast movers (ie, bullets) can't tunnel
+//   through thin or small targets
 
 #ifndef ITU_LIB_COLLISIONS_HPP
 #define ITU_LIB_COLLISIONS_HPP
 
+#include <SDL3/SDL_intrin.h>
+#include <SDL3/SDL_cpuinfo.h>
 #include <itu_common.hpp>
 
-// SDL functions used here (all coming from `itu_common`):
+// SDL functions used here (all coming from `itu_common`, except where noted):
 // - SDL_Log()
 // - SDL_sqrt()
 // - SDL_assert()
+// - SDL_HasAVX2(), SDL_HasSSE2() (from `SDL_cpuinfo`)
 
 
 bool itu_lib_overlaps_point_circle(vec2f point, vec2f circle_center, float circle_radius);
@@ -45,6 +65,185 @@ bool itu_lib_overlaps_circle_polygon(vec2f circle_center, float circle_radius, v
 bool itu_lib_overlaps_rect_polygon(vec2f rect_min, vec2f rect_max, vec2f* polygon_vertices, int poligon_vertices_count);
 bool itu_lib_overlaps_polygon_polygon(vec2f* polygon_0_vertices, int poligon_0_vertices_count, vec2f* polygon_1_vertices, int poligon_1_vertices_count, vec2f* out_simplex, int* out_simplex_count);
 
+int itu_lib_overlaps_circle_circles(vec2f circle_center, float circle_radius, float* circles_x, float* circles_y, float* circles_radius, int circles_count, int* out_hit_idxs);
+int itu_lib_overlaps_segment_circles(vec2f segment_a, vec2f segment_b, float* circles_x, float* circles_y, float* circles_radius, int circles_count, int* out_hit_idxs);
+
+// oriented rect
+// NOTE: `axis_x` is its local x axis (normalized), the local y axis is `axis_x` rotated 90 degrees CCW.
+//       Use `itu_lib_overlaps_obb_make()` to build one from a rotation, so sin/cos are computed only once
+struct OBB
+{
+	vec2f center;
+	vec2f half_extents;
+	vec2f axis_x;
+};
+
+OBB  itu_lib_overlaps_obb_make(vec2f obb_center, vec2f obb_half_extents, float obb_rotation);
+
+bool itu_lib_overlaps_point_capsule(vec2f point, vec2f capsule_a, vec2f capsule_b, float capsule_radius);
+bool itu_lib_overlaps_segment_capsule(vec2f segment_a, vec2f segment_b, vec2f capsule_a, vec2f capsule_b, float capsule_radius);
+bool itu_lib_overlaps_circle_capsule(vec2f circle_center, float circle_radius, vec2f capsule_a, vec2f capsule_b, float capsule_radius);
+bool itu_lib_overlaps_capsule_capsule(vec2f capsule_0_a, vec2f capsule_0_b, float capsule_0_radius, vec2f capsule_1_a, vec2f capsule_1_b, float capsule_1_radius);
+bool itu_lib_overlaps_capsule_rect(vec2f capsule_a, vec2f capsule_b, float capsule_radius, vec2f rect_min, vec2f rect_max);
+bool itu_lib_overlaps_capsule_obb(vec2f capsule_a, vec2f capsule_b, float capsule_radius, OBB obb);
+bool itu_lib_overlaps_capsule_polygon(vec2f capsule_a, vec2f capsule_b, float capsule_radius, vec2f* polygon_vertices, int poligon_vertices_count);
+
+bool itu_lib_overlaps_point_obb(vec2f point, OBB obb);
+bool itu_lib_overlaps_segment_obb(vec2f segment_a, vec2f segment_b, OBB obb);
+bool itu_lib_overlaps_circle_obb(vec2f circle_center, float circle_radius, OBB obb);
+bool itu_lib_overlaps_rect_obb(vec2f rect_min, vec2f rect_max, OBB obb);
+bool itu_lib_overlaps_obb_obb(OBB obb_0, OBB obb_1);
+bool itu_lib_overlaps_obb_polygon(OBB obb, vec2f* polygon_vertices, int poligon_vertices_count);
+
+enum ShapeType
+{
+	SHAPE_TYPE_CIRCLE,
+	SHAPE_TYPE_RECT,
+	SHAPE_TYPE_CAPSULE,
+	SHAPE_TYPE_POLYGON,
+
+	SHAPE_TYPE_MAX
+};
+
+// position and rotation of a shape
+// NOTE: sin/cos are cached, use `itu_lib_overlaps_shape_set_transform()` to change it
+struct ShapeTransform
+{
+	vec2f position;
+	float rotation; // in radians
+	float rotation_cos;
+	float rotation_sin;
+};
+
+// NOTE: shape data is in local space, and `transform` places it in the world. Constructors use the identity transform,
+//       so shapes built directly from world coordinates don't need to care about it
+// NOTE: the bounding circle is computed by the constructors, so either move shapes with their transform or build them again.
+//       Changing the shape data directly leaves a stale bounding circle
+// NOTE: polygons only store a pointer to their vertices, whoever creates the shape owns them
+struct Shape
+{
+	ShapeType      type;
+	ShapeTransform transform;
+
+	// bounding circle (in local space), cached by the constructors so far away pairs can be rejected before running GJK
+	vec2f bounding_center;
+	float bounding_radius;
+
+	union
+	{
+		struct { vec2f center; float radius; }          circle;
+		struct { vec2f min; vec2f max; }                rect;
+		struct { vec2f a; vec2f b; float radius; }      capsule; // segment a-b, "inflated" by radius
+		struct { vec2f* vertices; int vertices_count; } polygon;
+	};
+};
+
+// GJK state to carry over between frames for the same pair of shapes (ie, stored in a `PairTable` from itu_lib_pairs.hpp, keyed by entity ids)
+// - `direction` is the last search direction: the separating axis if the shapes were apart, so the next query can stop right away
+//   if they are still apart along it. Zero means "no history" (cold start)
+// - `simplex_directions` are the search directions that found the vertices of the last simplex, if the shapes overlapped
+//   (`simplex_count` is 3, 0 otherwise). The next query rebuilds the simplex from them, and if it still contains the origin
+//   (ie, a resting pair) the shapes still overlap, without a single iteration
+// - `iterations` is how many GJK iterations the last query took, for diagnostics
+// NOTE: directions are cached instead of the simplex vertices, since the vertices move with the shapes and the directions don't
+// NOTE: the directions are relative to the order of the shapes (shape_0 - shape_1), always pass the pair in the same order.
+//       Passing them swapped is still correct, just slower
+// NOTE: all zeroes is a valid cold start, so it can be the user data of a `PairTable` as is
+struct GJKCache
+{
+	vec2f direction;
+	vec2f simplex_directions[3];
+	int   simplex_count;
+	int   iterations;
+};
+
+Shape itu_lib_overlaps_shape_circle(vec2f circle_center, float circle_radius);
+Shape itu_lib_overlaps_shape_rect(vec2f rect_min, vec2f rect_max);
+Shape itu_lib_overlaps_shape_capsule(vec2f capsule_a, vec2f capsule_b, float capsule_radius);
+Shape itu_lib_overlaps_shape_polygon(vec2f* polygon_vertices, int poligon_vertices_count);
+void  itu_lib_overlaps_shape_set_transform(Shape* shape, vec2f position, float rotation);
+vec2f itu_lib_overlaps_shape_support(Shape* shape, vec2f direction);
+void  itu_lib_overlaps_shape_get_aabb(Shape* shape, vec2f* out_min, vec2f* out_max);
+bool  itu_lib_overlaps_shape_bounds(Shape* shape_0, Shape* shape_1);
+bool  itu_lib_overlaps_gjk(Shape* shape_0, Shape* shape_1, GJKCache* cache, vec2f* out_simplex, int* out_simplex_count);
+bool  itu_lib_overlaps_shape_shape(Shape* shape_0, Shape* shape_1);
+
+// result of a positive `itu_lib_collide_*` test
+// - `normal` goes from the first shape towards the second one (always normalized)
+// - `depth` is how much the shapes overlap along `normal`, so moving the first shape by `-normal * depth`
+//   (or the second one by `normal * depth`) separates them
+// - `point` is roughly in the middle of the overlapping area, good enough for effects and for applying impulses
+struct Contact
+{
+	vec2f normal;
+	float depth;
+	vec2f point;
+};
+
+bool itu_lib_collide_segment_circle(vec2f segment_a, vec2f segment_b, vec2f circle_center, float circle_radius, Contact* out_contact);
+bool itu_lib_collide_segment_segment(vec2f segment_0_a, vec2f segment_0_b, vec2f segment_1_a, vec2f segment_1_b, Contact* out_contact);
+bool itu_lib_collide_segment_rect(vec2f segment_a, vec2f segment_b, vec2f rect_min, vec2f rect_max, Contact* out_contact);
+bool itu_lib_collide_circle_circle(vec2f circle_center_0, float circle_radius_0, vec2f circle_center_1, float circle_radius_1, Contact* out_contact);
+bool itu_lib_collide_circle_rect(vec2f circle_center, float circle_radius, vec2f rect_min, vec2f rect_max, Contact* out_contact);
+bool itu_lib_collide_rect_rect(vec2f rect_min_0, vec2f rect_max_0, vec2f rect_min_1, vec2f rect_max_1, Contact* out_contact);
+
+bool itu_lib_collide_segment_polygon(vec2f segment_a, vec2f segment_b, vec2f* polygon_vertices, int poligon_vertices_count, Contact* out_contact);
+bool itu_lib_collide_circle_polygon(vec2f circle_center, float circle_radius, vec2f* polygon_vertices, int poligon_vertices_count, Contact* out_contact);
+bool itu_lib_collide_rect_polygon(vec2f rect_min, vec2f rect_max, vec2f* polygon_vertices, int poligon_vertices_count, Contact* out_contact);
+bool itu_lib_collide_polygon_polygon(vec2f* polygon_0_vertices, int poligon_0_vertices_count, vec2f* polygon_1_vertices, int poligon_1_vertices_count, Contact* out_contact);
+bool itu_lib_collide_polygon_polygon_epa(vec2f* polygon_0_vertices, int poligon_0_vertices_count, vec2f* polygon_1_vertices, int poligon_1_vertices_count, vec2f* simplex, int simplex_count, Contact* out_contact);
+
+bool itu_lib_collide_segment_capsule(vec2f segment_a, vec2f segment_b, vec2f capsule_a, vec2f capsule_b, float capsule_radius, Contact* out_contact);
+bool itu_lib_collide_circle_capsule(vec2f circle_center, float circle_radius, vec2f capsule_a, vec2f capsule_b, float capsule_radius, Contact* out_contact);
+bool itu_lib_collide_capsule_capsule(vec2f capsule_0_a, vec2f capsule_0_b, float capsule_0_radius, vec2f capsule_1_a, vec2f capsule_1_b, float capsule_1_radius, Contact* out_contact);
+bool itu_lib_collide_capsule_rect(vec2f capsule_a, vec2f capsule_b, float capsule_radius, vec2f rect_min, vec2f rect_max, Contact* out_contact);
+bool itu_lib_collide_capsule_obb(vec2f capsule_a, vec2f capsule_b, float capsule_radius, OBB obb, Contact* out_contact);
+bool itu_lib_collide_capsule_polygon(vec2f capsule_a, vec2f capsule_b, float capsule_radius, vec2f* polygon_vertices, int poligon_vertices_count, Contact* out_contact);
+
+bool itu_lib_collide_segment_obb(vec2f segment_a, vec2f segment_b, OBB obb, Contact* out_contact);
+bool itu_lib_collide_circle_obb(vec2f circle_center, float circle_radius, OBB obb, Contact* out_contact);
+bool itu_lib_collide_rect_obb(vec2f rect_min, vec2f rect_max, OBB obb, Contact* out_contact);
+bool itu_lib_collide_obb_obb(OBB obb_0, OBB obb_1, Contact* out_contact);
+bool itu_lib_collide_obb_polygon(OBB obb, vec2f* polygon_vertices, int poligon_vertices_count, Contact* out_contact);
+
+bool itu_lib_collide_epa(Shape* shape_0, Shape* shape_1, vec2f* simplex, int simplex_count, Contact* out_contact);
+bool itu_lib_collide_shape_shape(Shape* shape_0, Shape* shape_1, GJKCache* cache, Contact* out_contact);
+
+// convex polygon with its edge data computed once, for polygons that are tested a lot or have a lot of vertices (ie, terrain pieces)
+// NOTE: like `Shape`, it only stores pointers. Whoever creates it owns `vertices` and `normals` (space for `vertices_count` entries)
+// NOTE: if the vertices change, call `itu_lib_overlaps_convex_polygon_init()` again
+struct ConvexPolygon
+{
+	vec2f* vertices;
+	vec2f* normals;   // `normals[i]` is the outward normal (normalized) of the edge from `vertices[i]` to `vertices[i+1]`
+	int    vertices_count;
+
+	vec2f aabb_min;
+	vec2f aabb_max;
+	vec2f bounding_center;
+	float bounding_radius;
+};
+
+void  itu_lib_overlaps_convex_polygon_init(ConvexPolygon* polygon, vec2f* vertices, vec2f* normals, int vertices_count);
+float itu_lib_overlaps_convex_polygon_separation(ConvexPolygon* polygon_0, ConvexPolygon* polygon_1, int* out_edge_idx, int* out_vertex_idx);
+bool  itu_lib_overlaps_point_convex_polygon(vec2f point, ConvexPolygon* polygon);
+bool  itu_lib_overlaps_circle_convex_polygon(vec2f circle_center, float circle_radius, ConvexPolygon* polygon);
+bool  itu_lib_overlaps_convex_polygon_convex_polygon(ConvexPolygon* polygon_0, ConvexPolygon* polygon_1);
+bool  itu_lib_collide_circle_convex_polygon(vec2f circle_center, float circle_radius, ConvexPolygon* polygon, Contact* out_contact);
+bool  itu_lib_collide_convex_polygon_convex_polygon(ConvexPolygon* polygon_0, ConvexPolygon* polygon_1, Contact* out_contact);
+
+// time of impact tests
+// - `*_displacement` is how much the shape moves during the step, so a time of impact `t` means the shapes touch at `position + displacement * t`
+// - `out_toi` gets the time of impact in [0, 1] (0 if they already overlap at the start of the step)
+// - `out_normal` (can be NULL) goes from the first shape towards the second one at the time of impact, same as `Contact::normal`
+//   (for segments, "the first shape" is the segment start)
+bool itu_lib_sweep_segment_circle(vec2f segment_a, vec2f segment_b, vec2f circle_center, float circle_radius, float* out_toi, vec2f* out_normal);
+bool itu_lib_sweep_segment_rect(vec2f segment_a, vec2f segment_b, vec2f rect_min, vec2f rect_max, float* out_toi, vec2f* out_normal);
+bool itu_lib_sweep_circle_circle(vec2f circle_center_0, float circle_radius_0, vec2f circle_displacement_0, vec2f circle_center_1, float circle_radius_1, vec2f circle_displacement_1, float* out_toi, vec2f* out_normal);
+bool itu_lib_sweep_circle_rect(vec2f circle_center, float circle_radius, vec2f circle_displacement, vec2f rect_min, vec2f rect_max, vec2f rect_displacement, float* out_toi, vec2f* out_normal);
+bool itu_lib_sweep_rect_rect(vec2f rect_min_0, vec2f rect_max_0, vec2f rect_displacement_0, vec2f rect_min_1, vec2f rect_max_1, vec2f rect_displacement_1, float* out_toi, vec2f* out_normal);
+bool itu_lib_sweep_segment_shape(vec2f segment_a, vec2f segment_b, Shape* shape, float* out_toi, vec2f* out_normal);
+
 #if defined ITU_LIB_COLLISIONS_IMPLEMENTATION || defined ITU_UNITY_BUILD
 
 inline bool itu_lib_overlaps_point_circle(vec2f point, vec2f circle_center, float circle_radius)
@@ -59,20 +258,18 @@ inline bool itu_lib_overlaps_point_rect(vec2f point, vec2f rect_min, vec2f rect_
 
 inline bool itu_lib_overlaps_segment_circle(vec2f segment_a, vec2f segment_b, vec2f circle_center, float circle_radius)
 {
+	// NOTE: instead of intersecting the segment with the circle (which needs a square root, and breaks down when they miss),
+	//       we find the point of the segment closest to the circle center and check if that one is inside the circle.
+	//       A degenerate segment (a == b) gets a zero inverse length, and is tested as the point a
 	vec2f d = segment_b - segment_a;
-	vec2f f = segment_a - circle_center;
-	
-	float a = dot(d, d);
-	float b = 2*dot(f, d);
-	float c = dot(f, f) - circle_radius*circle_radius;
-
-	// TODO this sqrt is not needed, find formula to get rid of it
-	float discriminant = SDL_sqrt(b*b-4*a*c);
+	vec2f f = circle_center - segment_a;
 
-	float t1 = (-b - discriminant) / (2*a);
-	float t2 = (-b + discriminant) / (2*a);
+	float d_len_sq = dot(d, d);
+	float d_len_sq_inv = d_len_sq > 0 ? 1.0f / d_len_sq : 0;
+	float t = SDL_clamp(dot(f, d) * d_len_sq_inv, 0.0f, 1.0f);
 
-	return (t1 >= 0 && t1 <= 1) || (t2 >= 0 && t2 <= 1) || itu_lib_overlaps_point_circle(segment_a, circle_center, circle_radius);
+	vec2f e = f - d * t;
+	return dot(e, e) < circle_radius * circle_radius;
 }
 
 // NOTE: colinear segments are NOT considered overlapping!
@@ -137,27 +334,11 @@ inline bool itu_lib_overlaps_circle_circle(vec2f circle_center_0, float circle_r
 
 inline bool itu_lib_overlaps_circle_rect(vec2f circle_center, float circle_radius, vec2f rect_min, vec2f rect_max)
 {
-	vec2f a = vec2f{ rect_min.x, rect_min.y };	// d ---- c
-	vec2f b = vec2f{ rect_max.x, rect_min.y };	// |      |
-	vec2f c = vec2f{ rect_max.x, rect_max.y };	// |      |
-	vec2f d = vec2f{ rect_min.x, rect_max.y };	// a ---- b
-
-	// tests needed:
-	// 1. base case: is any of the rect's edges overlapping the circle?
-	// 2. circle fully contained in rect: we can just test the circle center against the rect itself
-	// 3. rect fully contained in circle: all vertices of the rect will be inside the rect (we can test any one of them)
-	// NOTE: tests are sorted from cheaper to most expensive, since we won't need to do any more tests after we get a positive
-	//       (see https://en.cppreference.com/w/cpp/language/operator_logical.html, "short-circuit evaluation)
-	return
-		// 3. rect fully contained in circle
-		itu_lib_overlaps_point_circle(a, circle_center, circle_radius) ||
-		// 2. circle fully contained in rec
-		itu_lib_overlaps_point_rect(circle_center, rect_min, rect_max) ||
-		// base tests: is any of the rect's edges overlapping the circle?
-		itu_lib_overlaps_segment_circle(a, b, circle_center, circle_radius) ||
-		itu_lib_overlaps_segment_circle(b, c, circle_center, circle_radius) ||
-		itu_lib_overlaps_segment_circle(c, d, circle_center, circle_radius) ||
-		itu_lib_overlaps_segment_circle(d, a, circle_center, circle_radius);
+	// NOTE: clamping the circle center to the rect gives the point of the rect closest to it, so one point-circle test
+	//       covers all cases (edges overlapping the circle, circle inside the rect, rect inside the circle).
+	//       If the center is inside the rect, the closest point is the center itself
+	vec2f closest = vec2f{ SDL_clamp(circle_center.x, rect_min.x, rect_max.x), SDL_clamp(circle_center.y, rect_min.y, rect_max.y) };
+	return itu_lib_overlaps_point_circle(closest, circle_center, circle_radius);
 }
 
 inline bool itu_lib_overlaps_rect_rect(vec2f rect_min_0, vec2f rect_max_0, vec2f rect_min_1, vec2f rect_max_1)
@@ -171,6 +352,288 @@ inline bool itu_lib_overlaps_rect_rect(vec2f rect_min_0, vec2f rect_max_0, vec2f
 		   rect_min_0.x < rect_max_1.x && rect_max_0.x > rect_min_1.x;
 }
 
+// *******************************************************************
+// batch circle tests
+// all kernels do exactly the same math as `itu_lib_overlaps_circle_circle()` (no fused multiply-add),
+// so they always agree with it. Each one handles as many full lanes as it can, and leaves the rest to the scalar version
+// *******************************************************************
+
+static int overlaps_circle_circles_scalar(float cx, float cy, float cr, float* xs, float* ys, float* rs, int beg, int count, int* out_hit_idxs, int hits_count)
+{
+	for(int i = beg; i < count; ++i)
+	{
+		float dx = cx - xs[i];
+		float dy = cy - ys[i];
+		float r  = cr + rs[i];
+
+		// NOTE: branchless compaction, the index is always written but only "kept" on a hit
+		out_hit_idxs[hits_count] = i;
+		hits_count += dx*dx + dy*dy < r*r;
+	}
+	return hits_count;
+}
+
+// writes the indices of the lanes set in `mask` (`lanes` bits, starting from index `base`)
+static inline int overlaps_compact_mask(int mask, int lanes, int base, int* out_hit_idxs, int hits_count)
+{
+	for(int lane = 0; lane < lanes; ++lane)
+	{
+		out_hit_idxs[hits_count] = base + lane;
+		hits_count += (mask >> lane) & 1;
+	}
+	return hits_count;
+}
+
+#if defined SDL_SSE2_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+static int SDL_TARGETING("sse2") overlaps_circle_circles_sse2(float cx, float cy, float cr, float* xs, float* ys, float* rs, int count, int* out_hit_idxs)
+{
+	__m128 cx4 = _mm_set1_ps(cx);
+	__m128 cy4 = _mm_set1_ps(cy);
+	__m128 cr4 = _mm_set1_ps(cr);
+
+	int hits_count = 0;
+	int i = 0;
+	for(; i + 4 <= count; i += 4)
+	{
+		__m128 dx = _mm_sub_ps(cx4, _mm_loadu_ps(xs + i));
+		__m128 dy = _mm_sub_ps(cy4, _mm_loadu_ps(ys + i));
+		__m128 r  = _mm_add_ps(cr4, _mm_loadu_ps(rs + i));
+		__m128 d_sq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+		int mask = _mm_movemask_ps(_mm_cmplt_ps(d_sq, _mm_mul_ps(r, r)));
+		if(mask)
+			hits_count = overlaps_compact_mask(mask, 4, i, out_hit_idxs, hits_count);
+	}
+	return overlaps_circle_circles_scalar(cx, cy, cr, xs, ys, rs, i, count, out_hit_idxs, hits_count);
+}
+#endif
+
+#if defined SDL_AVX2_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+static int SDL_TARGETING("avx2") overlaps_circle_circles_avx2(float cx, float cy, float cr, float* xs, float* ys, float* rs, int count, int* out_hit_idxs)
+{
+	__m256 cx8 = _mm256_set1_ps(cx);
+	__m256 cy8 = _mm256_set1_ps(cy);
+	__m256 cr8 = _mm256_set1_ps(cr);
+
+	int hits_count = 0;
+	int i = 0;
+	for(; i + 8 <= count; i += 8)
+	{
+		__m256 dx = _mm256_sub_ps(cx8, _mm256_loadu_ps(xs + i));
+		__m256 dy = _mm256_sub_ps(cy8, _mm256_loadu_ps(ys + i));
+		__m256 r  = _mm256_add_ps(cr8, _mm256_loadu_ps(rs + i));
+		__m256 d_sq = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+
+		int mask = _mm256_movemask_ps(_mm256_cmp_ps(d_sq, _mm256_mul_ps(r, r), _CMP_LT_OQ));
+		if(mask)
+			hits_count = overlaps_compact_mask(mask, 8, i, out_hit_idxs, hits_count);
+	}
+	return overlaps_circle_circles_scalar(cx, cy, cr, xs, ys, rs, i, count, out_hit_idxs, hits_count);
+}
+#endif
+
+#if defined SDL_NEON_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+static int overlaps_circle_circles_neon(float cx, float cy, float cr, float* xs, float* ys, float* rs, int count, int* out_hit_idxs)
+{
+	float32x4_t cx4 = vdupq_n_f32(cx);
+	float32x4_t cy4 = vdupq_n_f32(cy);
+	float32x4_t cr4 = vdupq_n_f32(cr);
+
+	// NOTE: NEON has no movemask, so we "and" the comparison with each lane's bit and add them together
+	const uint32_t lane_bits_data[4] = { 1, 2, 4, 8 };
+	uint32x4_t lane_bits = vld1q_u32(lane_bits_data);
+
+	int hits_count = 0;
+	int i = 0;
+	for(; i + 4 <= count; i += 4)
+	{
+		float32x4_t dx = vsubq_f32(cx4, vld1q_f32(xs + i));
+		float32x4_t dy = vsubq_f32(cy4, vld1q_f32(ys + i));
+		float32x4_t r  = vaddq_f32(cr4, vld1q_f32(rs + i));
+		float32x4_t d_sq = vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy));
+
+		uint32x4_t hit = vandq_u32(vcltq_f32(d_sq, vmulq_f32(r, r)), lane_bits);
+		uint32x2_t sum = vpadd_u32(vget_low_u32(hit), vget_high_u32(hit));
+		int mask = (int)vget_lane_u32(vpadd_u32(sum, sum), 0);
+		if(mask)
+			hits_count = overlaps_compact_mask(mask, 4, i, out_hit_idxs, hits_count);
+	}
+	return overlaps_circle_circles_scalar(cx, cy, cr, xs, ys, rs, i, count, out_hit_idxs, hits_count);
+}
+#endif
+
+// tests one circle against `circles_count` circles, stored in SoA layout
+// writes the indices of the overlapping ones (in increasing order) in `out_hit_idxs`, and returns how many there are
+// NOTE: `out_hit_idxs` must have space for `circles_count` entries, even if less are going to be returned
+int itu_lib_overlaps_circle_circles(vec2f circle_center, float circle_radius, float* circles_x, float* circles_y, float* circles_radius, int circles_count, int* out_hit_idxs)
+{
+	float cx = circle_center.x;
+	float cy = circle_center.y;
+	float cr = circle_radius;
+
+#if defined SDL_AVX2_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+	// NOTE: checking cpu features is not free, so we only do it once (and static initialization is thread-safe)
+	static const bool has_avx2 = SDL_HasAVX2();
+	if(has_avx2)
+		return overlaps_circle_circles_avx2(cx, cy, cr, circles_x, circles_y, circles_radius, circles_count, out_hit_idxs);
+#endif
+#if defined SDL_SSE2_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+	static const bool has_sse2 = SDL_HasSSE2();
+	if(has_sse2)
+		return overlaps_circle_circles_sse2(cx, cy, cr, circles_x, circles_y, circles_radius, circles_count, out_hit_idxs);
+#endif
+#if defined SDL_NEON_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+	return overlaps_circle_circles_neon(cx, cy, cr, circles_x, circles_y, circles_radius, circles_count, out_hit_idxs);
+#endif
+
+	return overlaps_circle_circles_scalar(cx, cy, cr, circles_x, circles_y, circles_radius, 0, circles_count, out_hit_idxs, 0);
+}
+
+// segment kernels do the same math as `itu_lib_overlaps_segment_circle()`: closest point on the segment, then point-circle test
+// (ax, ay) is the segment start, (dx, dy) its direction and `d_inv` is 1/|d|^2 (0 for degenerate segments)
+
+static int overlaps_segment_circles_scalar(float ax, float ay, float dx, float dy, float d_inv, float* xs, float* ys, float* rs, int beg, int count, int* out_hit_idxs, int hits_count)
+{
+	for(int i = beg; i < count; ++i)
+	{
+		float fx = xs[i] - ax;
+		float fy = ys[i] - ay;
+		float t  = SDL_clamp((fx*dx + fy*dy) * d_inv, 0.0f, 1.0f);
+		float ex = fx - dx*t;
+		float ey = fy - dy*t;
+
+		out_hit_idxs[hits_count] = i;
+		hits_count += ex*ex + ey*ey < rs[i]*rs[i];
+	}
+	return hits_count;
+}
+
+#if defined SDL_SSE2_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+static int SDL_TARGETING("sse2") overlaps_segment_circles_sse2(float ax, float ay, float dx, float dy, float d_inv, float* xs, float* ys, float* rs, int count, int* out_hit_idxs)
+{
+	__m128 ax4 = _mm_set1_ps(ax);
+	__m128 ay4 = _mm_set1_ps(ay);
+	__m128 dx4 = _mm_set1_ps(dx);
+	__m128 dy4 = _mm_set1_ps(dy);
+	__m128 d_inv4 = _mm_set1_ps(d_inv);
+	__m128 zero4  = _mm_setzero_ps();
+	__m128 one4   = _mm_set1_ps(1.0f);
+
+	int hits_count = 0;
+	int i = 0;
+	for(; i + 4 <= count; i += 4)
+	{
+		__m128 fx = _mm_sub_ps(_mm_loadu_ps(xs + i), ax4);
+		__m128 fy = _mm_sub_ps(_mm_loadu_ps(ys + i), ay4);
+		__m128 r  = _mm_loadu_ps(rs + i);
+		__m128 t  = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(fx, dx4), _mm_mul_ps(fy, dy4)), d_inv4);
+		t = _mm_min_ps(_mm_max_ps(t, zero4), one4);
+		__m128 ex = _mm_sub_ps(fx, _mm_mul_ps(dx4, t));
+		__m128 ey = _mm_sub_ps(fy, _mm_mul_ps(dy4, t));
+		__m128 e_sq = _mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey));
+
+		int mask = _mm_movemask_ps(_mm_cmplt_ps(e_sq, _mm_mul_ps(r, r)));
+		if(mask)
+			hits_count = overlaps_compact_mask(mask, 4, i, out_hit_idxs, hits_count);
+	}
+	return overlaps_segment_circles_scalar(ax, ay, dx, dy, d_inv, xs, ys, rs, i, count, out_hit_idxs, hits_count);
+}
+#endif
+
+#if defined SDL_AVX2_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+static int SDL_TARGETING("avx2") overlaps_segment_circles_avx2(float ax, float ay, float dx, float dy, float d_inv, float* xs, float* ys, float* rs, int count, int* out_hit_idxs)
+{
+	__m256 ax8 = _mm256_set1_ps(ax);
+	__m256 ay8 = _mm256_set1_ps(ay);
+	__m256 dx8 = _mm256_set1_ps(dx);
+	__m256 dy8 = _mm256_set1_ps(dy);
+	__m256 d_inv8 = _mm256_set1_ps(d_inv);
+	__m256 zero8  = _mm256_setzero_ps();
+	__m256 one8   = _mm256_set1_ps(1.0f);
+
+	int hits_count = 0;
+	int i = 0;
+	for(; i + 8 <= count; i += 8)
+	{
+		__m256 fx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), ax8);
+		__m256 fy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), ay8);
+		__m256 r  = _mm256_loadu_ps(rs + i);
+		__m256 t  = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(fx, dx8), _mm256_mul_ps(fy, dy8)), d_inv8);
+		t = _mm256_min_ps(_mm256_max_ps(t, zero8), one8);
+		__m256 ex = _mm256_sub_ps(fx, _mm256_mul_ps(dx8, t));
+		__m256 ey = _mm256_sub_ps(fy, _mm256_mul_ps(dy8, t));
+		__m256 e_sq = _mm256_add_ps(_mm256_mul_ps(ex, ex), _mm256_mul_ps(ey, ey));
+
+		int mask = _mm256_movemask_ps(_mm256_cmp_ps(e_sq, _mm256_mul_ps(r, r), _CMP_LT_OQ));
+		if(mask)
+			hits_count = overlaps_compact_mask(mask, 8, i, out_hit_idxs, hits_count);
+	}
+	return overlaps_segment_circles_scalar(ax, ay, dx, dy, d_inv, xs, ys, rs, i, count, out_hit_idxs, hits_count);
+}
+#endif
+
+#if defined SDL_NEON_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+static int overlaps_segment_circles_neon(float ax, float ay, float dx, float dy, float d_inv, float* xs, float* ys, float* rs, int count, int* out_hit_idxs)
+{
+	float32x4_t ax4 = vdupq_n_f32(ax);
+	float32x4_t ay4 = vdupq_n_f32(ay);
+	float32x4_t dx4 = vdupq_n_f32(dx);
+	float32x4_t dy4 = vdupq_n_f32(dy);
+	float32x4_t d_inv4 = vdupq_n_f32(d_inv);
+	float32x4_t zero4  = vdupq_n_f32(0.0f);
+	float32x4_t one4   = vdupq_n_f32(1.0f);
+
+	const uint32_t lane_bits_data[4] = { 1, 2, 4, 8 };
+	uint32x4_t lane_bits = vld1q_u32(lane_bits_data);
+
+	int hits_count = 0;
+	int i = 0;
+	for(; i + 4 <= count; i += 4)
+	{
+		float32x4_t fx = vsubq_f32(vld1q_f32(xs + i), ax4);
+		float32x4_t fy = vsubq_f32(vld1q_f32(ys + i), ay4);
+		float32x4_t r  = vld1q_f32(rs + i);
+		float32x4_t t  = vmulq_f32(vaddq_f32(vmulq_f32(fx, dx4), vmulq_f32(fy, dy4)), d_inv4);
+		t = vminq_f32(vmaxq_f32(t, zero4), one4);
+		float32x4_t ex = vsubq_f32(fx, vmulq_f32(dx4, t));
+		float32x4_t ey = vsubq_f32(fy, vmulq_f32(dy4, t));
+		float32x4_t e_sq = vaddq_f32(vmulq_f32(ex, ex), vmulq_f32(ey, ey));
+
+		uint32x4_t hit = vandq_u32(vcltq_f32(e_sq, vmulq_f32(r, r)), lane_bits);
+		uint32x2_t sum = vpadd_u32(vget_low_u32(hit), vget_high_u32(hit));
+		int mask = (int)vget_lane_u32(vpadd_u32(sum, sum), 0);
+		if(mask)
+			hits_count = overlaps_compact_mask(mask, 4, i, out_hit_idxs, hits_count);
+	}
+	return overlaps_segment_circles_scalar(ax, ay, dx, dy, d_inv, xs, ys, rs, i, count, out_hit_idxs, hits_count);
+}
+#endif
+
+// tests one segment against `circles_count` circles, stored in SoA layout (same output as `itu_lib_overlaps_circle_circles()`)
+// NOTE: `out_hit_idxs` must have space for `circles_count` entries, even if less are going to be returned
+int itu_lib_overlaps_segment_circles(vec2f segment_a, vec2f segment_b, float* circles_x, float* circles_y, float* circles_radius, int circles_count, int* out_hit_idxs)
+{
+	vec2f d = segment_b - segment_a;
+	float d_len_sq = dot(d, d);
+	float d_inv = d_len_sq > 0 ? 1.0f / d_len_sq : 0;
+
+#if defined SDL_AVX2_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+	static const bool has_avx2 = SDL_HasAVX2();
+	if(has_avx2)
+		return overlaps_segment_circles_avx2(segment_a.x, segment_a.y, d.x, d.y, d_inv, circles_x, circles_y, circles_radius, circles_count, out_hit_idxs);
+#endif
+#if defined SDL_SSE2_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+	static const bool has_sse2 = SDL_HasSSE2();
+	if(has_sse2)
+		return overlaps_segment_circles_sse2(segment_a.x, segment_a.y, d.x, d.y, d_inv, circles_x, circles_y, circles_radius, circles_count, out_hit_idxs);
+#endif
+#if defined SDL_NEON_INTRINSICS && !defined ITU_LIB_OVERLAPS_DISABLE_SIMD
+	return overlaps_segment_circles_neon(segment_a.x, segment_a.y, d.x, d.y, d_inv, circles_x, circles_y, circles_radius, circles_count, out_hit_idxs);
+#endif
+
+	return overlaps_segment_circles_scalar(segment_a.x, segment_a.y, d.x, d.y, d_inv, circles_x, circles_y, circles_radius, 0, circles_count, out_hit_idxs, 0);
+}
+
 bool itu_lib_overlaps_point_polygon(vec2f point, vec2f* polygon_vertices, int poligon_vertices_count)
 {
 	SDL_assert(polygon_vertices);
@@ -219,13 +682,11 @@ bool itu_lib_overlaps_circle_polygon(vec2f circle_center, float circle_radius, v
 	if(itu_lib_overlaps_point_polygon(circle_center, polygon_vertices, poligon_vertices_count))
 		return true;
 
+	// NOTE: the segment test also covers vertices inside the circle (they are the closest point of their edges)
 	for(int i = 0; i < poligon_vertices_count; ++i)
 	{
 		vec2f a = polygon_vertices[i];
 		vec2f b = polygon_vertices[(i + 1) % poligon_vertices_count];
-		
-		if(itu_lib_overlaps_point_circle(a, circle_center, circle_radius))
-			return true;
 
 		if(itu_lib_overlaps_segment_circle(a, b, circle_center, circle_radius))
 			return true;
@@ -280,46 +741,91 @@ static vec2f gjk_support_polygon(vec2f dir, vec2f* vertices, int vertices_count)
 	return ret;
 }
 
-// NOTE: assumes polygons are convex AND counter0clockwise
-bool itu_lib_overlaps_polygon_polygon(vec2f* polygon_0_vertices, int poligon_0_vertices_count, vec2f* polygon_1_vertices, int poligon_1_vertices_count, vec2f* out_simplex)
+// support point of the Minkowski difference shape_0 - shape_1
+static inline vec2f gjk_support(Shape* shape_0, Shape* shape_1, vec2f direction)
 {
-	SDL_assert(polygon_0_vertices);
-	SDL_assert(polygon_1_vertices);
+	return itu_lib_overlaps_shape_support(shape_0, direction) - itu_lib_overlaps_shape_support(shape_1, -direction);
+}
+
+// true if the origin is strictly inside the triangle (in any winding order)
+static inline bool gjk_triangle_contains_origin(vec2f* triangle)
+{
+	float c0 = cross(triangle[1] - triangle[0], -triangle[0]);
+	float c1 = cross(triangle[2] - triangle[1], -triangle[1]);
+	float c2 = cross(triangle[0] - triangle[2], -triangle[2]);
+	return (c0 > 0 && c1 > 0 && c2 > 0) || (c0 < 0 && c1 < 0 && c2 < 0);
+}
+
+// GJK overlap test between any two convex shapes
+// if they overlap, the last simplex is copied in `out_simplex` (space for 3 vertices, can be NULL). It can be passed to `itu_lib_collide_epa()`
+// `cache` can be NULL, if given the search starts from (and then updates) the simplex or direction found during the last query on the same pair
+// NOTE: this doesn't run the bounding circle test, use `itu_lib_overlaps_shape_shape()` for that
+bool itu_lib_overlaps_gjk(Shape* shape_0, Shape* shape_1, GJKCache* cache, vec2f* out_simplex, int* out_simplex_count)
+{
+	SDL_assert(shape_0);
+	SDL_assert(shape_1);
 
 	// main GJK implementation
 	// from https://www.youtube.com/watch?v=Qupqu1xe7Io (adapted for 2D)
 	// NOTE: we need only 3 vertices, since the 2D simplex is a triangle
 	// NOTE: most algorithms that perform separation of arbitrary polygons will need the last simplex found by GJK
 	vec2f support_points[3] = { };
-	vec2f closest_points1[3] = { };
-	vec2f closest_points2[3] = { };
+	vec2f support_directions[3] = { }; // direction each support point was found with, for `GJKCache`
 	int support_points_count = 0;
 
-	// NOTE: choose appropriate first direction
+	// NOTE: warm start from the last simplex, if the shapes overlapped last time
+	if(cache && cache->simplex_count == 3)
+	{
+		for(int k = 0; k < 3; ++k)
+			support_points[k] = gjk_support(shape_0, shape_1, cache->simplex_directions[k]);
+
+		if(gjk_triangle_contains_origin(support_points))
+		{
+			cache->iterations = 0;
+			if(out_simplex)
+				SDL_memcpy(out_simplex, support_points, 3 * sizeof(vec2f));
+			if(out_simplex_count)
+				*out_simplex_count = 3;
+			return true;
+		}
+	}
+
+	// NOTE: choose appropriate first direction (warm start from the last query, if we have one)
 	vec2f direction = VEC2F_UP;
+	if(cache && (cache->direction.x != 0 || cache->direction.y != 0))
+		direction = cache->direction;
 
-	// NOTE: hardcoding the support function here because the purpose of this library is illustrative.
-	//       the true power of GJK comes form the fact that the algorithms works exactly the same *disregarding the support function implementation*
-	//       We could just pass arbitrary data and a type (ie, tagged union or similar) and we have an extrimely performant function that works for
-	//       all shapes
-	closest_points1[support_points_count] = gjk_support_polygon(direction, polygon_0_vertices, poligon_0_vertices_count);
-	closest_points2[support_points_count] = gjk_support_polygon(-direction, polygon_1_vertices, poligon_1_vertices_count);
-	support_points[support_points_count++] = closest_points1[support_points_count] - closest_points2[support_points_count];
-	direction = -support_points[0];
+	// NOTE: the true power of GJK comes form the fact that the algorithms works exactly the same *disregarding the support function implementation*,
+	//       so every shape in `Shape` goes through this same code
+	support_directions[support_points_count] = direction;
+	support_points[support_points_count++] = gjk_support(shape_0, shape_1, direction);
 
 	const int max_iter = 128;
 	int i = 0;
 	bool ret = false;
 
+	// if even the farthest point along the direction is behind the origin, it's a separating axis and we are done
+	// (this is what makes warm starting pay off: shapes that stay apart stop here)
+	if(dot(support_points[0], direction) < 0)
+	{
+		if(cache)
+		{
+			cache->direction     = direction;
+			cache->simplex_count = 0;
+			cache->iterations    = 0;
+		}
+		return false;
+	}
+	direction = -support_points[0];
+
 	for(i = 0; i < max_iter; ++i)
 	{
-		closest_points1[support_points_count] = gjk_support_polygon(direction, polygon_0_vertices, poligon_0_vertices_count);
-		closest_points2[support_points_count] = gjk_support_polygon(-direction, polygon_1_vertices, poligon_1_vertices_count);
-		vec2f a = closest_points1[support_points_count] - closest_points2[support_points_count];
+		vec2f a = gjk_support(shape_0, shape_1, direction);
 
 		if(dot(a, direction) < 0)
 			break;
 
+		support_directions[support_points_count] = direction;
 		support_points[support_points_count++] = a;
 
 		// do simplex
@@ -356,6 +862,7 @@ bool itu_lib_overlaps_polygon_polygon(vec2f* polygon_0_vertices, int poligon_0_v
 				{
 					// if the origin points away from B, we need to search in the direction of the origin
 					support_points[0] = a;
+					support_directions[0] = support_directions[1];
 					support_points_count = 1;
 					direction = a0;
 				}
@@ -365,31 +872,40 @@ bool itu_lib_overlaps_polygon_polygon(vec2f* polygon_0_vertices, int poligon_0_v
 			{
 				vec2f c = support_points[support_points_count-3];
 				vec2f ac = c - a;
-				float sign_ac = dot(ac, a0);
 
-				if(sign_ab > 0 && sign_ac > 0)
-				{
-					// inside the triangle
-					ret = true;
-					break;
-				}
-				else if(sign_ac > 0)
+				// perpendiculars of the two edges that contain the new point, pointing out of the triangle
+				// (the third edge doesn't need to be tested, we came from that side)
+				vec2f ab_perp = vec2f{ ab.y, -ab.x };
+				vec2f ac_perp = vec2f{ ac.y, -ac.x };
+				if(dot(ab_perp, ac) > 0)
+					ab_perp = -ab_perp;
+				if(dot(ac_perp, ab) > 0)
+					ac_perp = -ac_perp;
+
+				if(dot(ab_perp, a0) > 0)
 				{
-					//case AC
-					support_points[0] = c;
+					// case AB: origin outside of edge AB, drop C
+					support_points[0] = b;
 					support_points[1] = a;
+					support_directions[0] = support_directions[1];
+					support_directions[1] = support_directions[2];
 					support_points_count = 2;
-					direction = cross_triplet(ac, a0, ac);
+					direction = ab_perp;
 					continue;
 				}
-				else
+				else if(dot(ac_perp, a0) > 0)
 				{
-					support_points[0] = b;
+					// case AC: origin outside of edge AC, drop B
+					support_points[0] = c;
 					support_points[1] = a;
+					support_directions[1] = support_directions[2];
 					support_points_count = 2;
-					direction = cross_triplet(ab, a0, ab);
+					direction = ac_perp;
 					continue;
 				}
+
+				// inside the triangle
+				ret = true;
 				break;
 			}
 			else
@@ -400,6 +916,1654 @@ bool itu_lib_overlaps_polygon_polygon(vec2f* polygon_0_vertices, int poligon_0_v
 			}
 		}
 	}
+
+	if(cache)
+	{
+		// NOTE: the search direction is never normalized during the iterations, so its length can get really big or small.
+		//       Normalizing it once here keeps the cached value well behaved
+		vec2f direction_normalized = normalize(direction);
+		if(direction_normalized.x != 0 || direction_normalized.y != 0)
+			cache->direction = direction_normalized;
+		cache->iterations = i + 1;
+
+		cache->simplex_count = ret ? 3 : 0;
+		if(ret)
+			SDL_memcpy(cache->simplex_directions, support_directions, 3 * sizeof(vec2f));
+	}
+
+	if(ret)
+	{
+		if(out_simplex)
+			SDL_memcpy(out_simplex, support_points, support_points_count * sizeof(vec2f));
+		if(out_simplex_count)
+			*out_simplex_count = support_points_count;
+	}
+	return ret;
+}
+
+// polygons don't need their bounding circle here, so we skip the constructor
+static inline Shape shape_polygon_identity(vec2f* polygon_vertices, int poligon_vertices_count)
+{
+	Shape ret = { };
+	ret.type = SHAPE_TYPE_POLYGON;
+	ret.transform.rotation_cos = 1;
+	ret.polygon.vertices = polygon_vertices;
+	ret.polygon.vertices_count = poligon_vertices_count;
+	return ret;
+}
+
+// NOTE: assumes polygons are convex AND counter0clockwise
+// if they overlap, the last simplex is copied in `out_simplex` (space for 3 vertices, can be NULL). It can be passed to `itu_lib_collide_polygon_polygon_epa()`
+bool itu_lib_overlaps_polygon_polygon(vec2f* polygon_0_vertices, int poligon_0_vertices_count, vec2f* polygon_1_vertices, int poligon_1_vertices_count, vec2f* out_simplex, int* out_simplex_count)
+{
+	SDL_assert(polygon_0_vertices);
+	SDL_assert(polygon_1_vertices);
+
+	Shape shape_0 = shape_polygon_identity(polygon_0_vertices, poligon_0_vertices_count);
+	Shape shape_1 = shape_polygon_identity(polygon_1_vertices, poligon_1_vertices_count);
+	return itu_lib_overlaps_gjk(&shape_0, &shape_1, NULL, out_simplex, out_simplex_count);
+}
+
+static inline vec2f shape_transform_point(ShapeTransform* transform, vec2f point)
+{
+	return vec2f{
+		point.x * transform->rotation_cos - point.y * transform->rotation_sin,
+		point.x * transform->rotation_sin + point.y * transform->rotation_cos
+	} + transform->position;
+}
+
+// shared by all constructors: identity transform and no bounds
+static inline Shape shape_make(ShapeType type)
+{
+	Shape ret = { };
+	ret.type = type;
+	ret.transform.rotation_cos = 1;
+	return ret;
+}
+
+Shape itu_lib_overlaps_shape_circle(vec2f circle_center, float circle_radius)
+{
+	Shape ret = shape_make(SHAPE_TYPE_CIRCLE);
+	ret.circle.center = circle_center;
+	ret.circle.radius = circle_radius;
+	ret.bounding_center = circle_center;
+	ret.bounding_radius = circle_radius;
+	return ret;
+}
+
+Shape itu_lib_overlaps_shape_rect(vec2f rect_min, vec2f rect_max)
+{
+	Shape ret = shape_make(SHAPE_TYPE_RECT);
+	ret.rect.min = rect_min;
+	ret.rect.max = rect_max;
+	ret.bounding_center = (rect_min + rect_max) * 0.5f;
+	ret.bounding_radius = length(rect_max - ret.bounding_center);
+	return ret;
+}
+
+Shape itu_lib_overlaps_shape_capsule(vec2f capsule_a, vec2f capsule_b, float capsule_radius)
+{
+	Shape ret = shape_make(SHAPE_TYPE_CAPSULE);
+	ret.capsule.a = capsule_a;
+	ret.capsule.b = capsule_b;
+	ret.capsule.radius = capsule_radius;
+	ret.bounding_center = (capsule_a + capsule_b) * 0.5f;
+	ret.bounding_radius = length(capsule_b - ret.bounding_center) + capsule_radius;
+	return ret;
+}
+
+Shape itu_lib_overlaps_shape_polygon(vec2f* polygon_vertices, int poligon_vertices_count)
+{
+	SDL_assert(polygon_vertices && poligon_vertices_count > 0);
+
+	Shape ret = shape_make(SHAPE_TYPE_POLYGON);
+	ret.polygon.vertices = polygon_vertices;
+	ret.polygon.vertices_count = poligon_vertices_count;
+
+	// NOTE: the center of the AABB is not the center of the smallest bounding circle, but it's close enough for an early-out
+	vec2f min = polygon_vertices[0];
+	vec2f max = polygon_vertices[0];
+	for(int i = 1; i < poligon_vertices_count; ++i)
+	{
+		min = vec2f{ SDL_min(min.x, polygon_vertices[i].x), SDL_min(min.y, polygon_vertices[i].y) };
+		max = vec2f{ SDL_max(max.x, polygon_vertices[i].x), SDL_max(max.y, polygon_vertices[i].y) };
+	}
+	ret.bounding_center = (min + max) * 0.5f;
+
+	float radius_sq = 0;
+	for(int i = 0; i < poligon_vertices_count; ++i)
+		radius_sq = SDL_max(radius_sq, length_sq(polygon_vertices[i] - ret.bounding_center));
+	ret.bounding_radius = SDL_sqrtf(radius_sq);
+	return ret;
+}
+
+void itu_lib_overlaps_shape_set_transform(Shape* shape, vec2f position, float rotation)
+{
+	SDL_assert(shape);
+
+	shape->transform.position = position;
+	shape->transform.rotation = rotation;
+	shape->transform.rotation_cos = SDL_cosf(rotation);
+	shape->transform.rotation_sin = SDL_sinf(rotation);
+}
+
+// farthest point of the shape along `direction` (in world space, `direction` doesn't need to be normalized)
+vec2f itu_lib_overlaps_shape_support(Shape* shape, vec2f direction)
+{
+	SDL_assert(shape);
+
+	// bring the direction in local space (inverse rotation), and the result back in world space
+	ShapeTransform* transform = &shape->transform;
+	vec2f dir = vec2f{
+		 direction.x * transform->rotation_cos + direction.y * transform->rotation_sin,
+		-direction.x * transform->rotation_sin + direction.y * transform->rotation_cos
+	};
+
+	vec2f ret;
+	switch(shape->type)
+	{
+		case SHAPE_TYPE_CIRCLE:
+			ret = shape->circle.center + normalize(dir) * shape->circle.radius;
+			break;
+		case SHAPE_TYPE_RECT:
+			ret = vec2f{ dir.x > 0 ? shape->rect.max.x : shape->rect.min.x, dir.y > 0 ? shape->rect.max.y : shape->rect.min.y };
+			break;
+		case SHAPE_TYPE_CAPSULE:
+			ret = (dot(shape->capsule.a, dir) > dot(shape->capsule.b, dir) ? shape->capsule.a : shape->capsule.b) + normalize(dir) * shape->capsule.radius;
+			break;
+		case SHAPE_TYPE_POLYGON:
+			ret = gjk_support_polygon(dir, shape->polygon.vertices, shape->polygon.vertices_count);
+			break;
+		default:
+			SDL_assert(false);
+			ret = VEC2F_ZERO;
+	}
+
+	return shape_transform_point(transform, ret);
+}
+
+void itu_lib_overlaps_shape_get_aabb(Shape* shape, vec2f* out_min, vec2f* out_max)
+{
+	SDL_assert(shape);
+
+	// all shapes are the convex hull of a few points (inflated by a radius, for the round ones)
+	vec2f points[4];
+	vec2f* vertices = points;
+	int    vertices_count = 0;
+	float  radius = 0;
+	switch(shape->type)
+	{
+		case SHAPE_TYPE_CIRCLE:
+			points[vertices_count++] = shape->circle.center;
+			radius = shape->circle.radius;
+			break;
+		case SHAPE_TYPE_RECT:
+			points[vertices_count++] = vec2f{ shape->rect.min.x, shape->rect.min.y };
+			points[vertices_count++] = vec2f{ shape->rect.max.x, shape->rect.min.y };
+			points[vertices_count++] = vec2f{ shape->rect.max.x, shape->rect.max.y };
+			points[vertices_count++] = vec2f{ shape->rect.min.x, shape->rect.max.y };
+			break;
+		case SHAPE_TYPE_CAPSULE:
+			points[vertices_count++] = shape->capsule.a;
+			points[vertices_count++] = shape->capsule.b;
+			radius = shape->capsule.radius;
+			break;
+		case SHAPE_TYPE_POLYGON:
+			vertices = shape->polygon.vertices;
+			vertices_count = shape->polygon.vertices_count;
+			break;
+		default:
+			SDL_assert(false);
+	}
+
+	SDL_assert(vertices_count > 0);
+	vec2f min = shape_transform_point(&shape->transform, vertices[0]);
+	vec2f max = min;
+	for(int i = 1; i < vertices_count; ++i)
+	{
+		vec2f v = shape_transform_point(&shape->transform, vertices[i]);
+		min.x = SDL_min(min.x, v.x);
+		min.y = SDL_min(min.y, v.y);
+		max.x = SDL_max(max.x, v.x);
+		max.y = SDL_max(max.y, v.y);
+	}
+	*out_min = min - radius;
+	*out_max = max + radius;
+}
+
+// bounding circles test, cheap early-out to run before anything more expensive
+bool itu_lib_overlaps_shape_bounds(Shape* shape_0, Shape* shape_1)
+{
+	SDL_assert(shape_0);
+	SDL_assert(shape_1);
+
+	return itu_lib_overlaps_circle_circle(
+		shape_transform_point(&shape_0->transform, shape_0->bounding_center), shape_0->bounding_radius,
+		shape_transform_point(&shape_1->transform, shape_1->bounding_center), shape_1->bounding_radius
+	);
+}
+
+// overlap test between any two shapes
+bool itu_lib_overlaps_shape_shape(Shape* shape_0, Shape* shape_1)
+{
+	SDL_assert(shape_0);
+	SDL_assert(shape_1);
+
+	if(!itu_lib_overlaps_shape_bounds(shape_0, shape_1))
+		return false;
+
+	// NOTE: for two circles, the bounding circles test *is* the overlap test
+	if(shape_0->type == SHAPE_TYPE_CIRCLE && shape_1->type == SHAPE_TYPE_CIRCLE)
+		return true;
+
+	return itu_lib_overlaps_gjk(shape_0, shape_1, NULL, NULL, NULL);
+}
+
+// *******************************************************************
+// contacts
+// NOTE: all these functions do at most one square root, to normalize the final normal
+// *******************************************************************
+
+// closest point to `point` on the segment a-b
+static inline vec2f collide_closest_point_segment(vec2f point, vec2f segment_a, vec2f segment_b)
+{
+	vec2f d = segment_b - segment_a;
+	float d_len_sq = dot(d, d);
+	if(d_len_sq == 0)
+		return segment_a;
+
+	float t = SDL_clamp(dot(point - segment_a, d) / d_len_sq, 0.0f, 1.0f);
+	return segment_a + d * t;
+}
+
+// contact between a circle and a point that we already know is inside it (and at distance^2 `d_sq`)
+// `dir` goes from the circle center to the point, `fallback_dir` is used when they coincide (doesn't need to be normalized)
+static inline void collide_fill_circle_point(float circle_radius, vec2f dir, float d_sq, vec2f fallback_dir, vec2f point, Contact* out_contact)
+{
+	float d = SDL_sqrtf(d_sq);
+	if(d > 0)
+	{
+		out_contact->normal = dir / d;
+	}
+	else
+	{
+		// NOTE: degenerate case, this is the only path where we pay a second square root
+		out_contact->normal = normalize(fallback_dir);
+		if(length_sq(out_contact->normal) == 0)
+			out_contact->normal = VEC2F_UP;
+	}
+	out_contact->depth = circle_radius - d;
+	out_contact->point = point;
+}
+
+// projects the vertices on `axis` (not normalized)
+static inline void collide_project(vec2f* vertices, int vertices_count, vec2f axis, float* out_min, float* out_max)
+{
+	float min = dot(vertices[0], axis);
+	float max = min;
+	for(int i = 1; i < vertices_count; ++i)
+	{
+		float p = dot(vertices[i], axis);
+		min = SDL_min(min, p);
+		max = SDL_max(max, p);
+	}
+	*out_min = min;
+	*out_max = max;
+}
+
+// separating axis test between two convex vertex lists, used for every pair that has no round parts.
+// Candidate axes are the normals of the edges of both lists (a segment is a list of 2 vertices, which gives 1 axis)
+// NOTE: axes are not normalized, we compare overlap^2/|axis|^2 instead, so the only square root is for the final normal
+static bool collide_sat(vec2f* vertices_0, int vertices_count_0, vec2f* vertices_1, int vertices_count_1, Contact* out_contact)
+{
+	SDL_assert(vertices_0 && vertices_count_0 > 1);
+	SDL_assert(vertices_1 && vertices_count_1 > 1);
+
+	vec2f best_axis          = VEC2F_ZERO;
+	float best_overlap       = 0;
+	float best_overlap_ratio = -1;  // overlap^2 / |axis|^2 of the best axis so far (negative means none yet)
+
+	for(int list = 0; list < 2; ++list)
+	{
+		vec2f* vertices       = list == 0 ? vertices_0       : vertices_1;
+		int    vertices_count = list == 0 ? vertices_count_0 : vertices_count_1;
+
+		// NOTE: a segment has only one edge (the way back is the same axis)
+		int edges_count = vertices_count == 2 ? 1 : vertices_count;
+		for(int i = 0; i < edges_count; ++i)
+		{
+			vec2f edge = vertices[(i + 1) % vertices_count] - vertices[i];
+			vec2f axis = vec2f{ edge.y, -edge.x };
+			float axis_len_sq = length_sq(axis);
+			if(axis_len_sq == 0)
+				continue;
+
+			float min_0, max_0, min_1, max_1;
+			collide_project(vertices_0, vertices_count_0, axis, &min_0, &max_0);
+			collide_project(vertices_1, vertices_count_1, axis, &min_1, &max_1);
+
+			// push list 1 forward along the axis, or backward. Whichever is shorter
+			float overlap_forward  = max_0 - min_1;
+			float overlap_backward = max_1 - min_0;
+			float overlap = SDL_min(overlap_forward, overlap_backward);
+
+			// NOTE: strict test, same as the overlap functions
+			if(overlap <= 0)
+				return false;
+
+			float overlap_ratio = overlap * overlap / axis_len_sq;
+			if(best_overlap_ratio < 0 || overlap_ratio < best_overlap_ratio)
+			{
+				best_overlap_ratio = overlap_ratio;
+				best_overlap       = overlap;
+				best_axis          = overlap_forward < overlap_backward ? axis : -axis;
+			}
+		}
+	}
+
+	// NOTE: only happens if all edges are degenerate
+	if(best_overlap_ratio < 0)
+		return false;
+
+	float axis_len = SDL_sqrtf(length_sq(best_axis));
+	out_contact->normal = best_axis / axis_len;
+	out_contact->depth  = best_overlap / axis_len;
+
+	// deepest point of list 1 inside list 0, moved back by half the depth
+	vec2f deepest = vertices_1[0];
+	float deepest_p = dot(deepest, out_contact->normal);
+	for(int i = 1; i < vertices_count_1; ++i)
+	{
+		float p = dot(vertices_1[i], out_contact->normal);
+		if(p < deepest_p)
+		{
+			deepest_p = p;
+			deepest = vertices_1[i];
+		}
+	}
+	out_contact->point = deepest + out_contact->normal * (out_contact->depth * 0.5f);
+	return true;
+}
+
+// CCW vertices of a rect
+static inline void collide_rect_vertices(vec2f rect_min, vec2f rect_max, vec2f* out_vertices)
+{
+	out_vertices[0] = vec2f{ rect_min.x, rect_min.y };
+	out_vertices[1] = vec2f{ rect_max.x, rect_min.y };
+	out_vertices[2] = vec2f{ rect_max.x, rect_max.y };
+	out_vertices[3] = vec2f{ rect_min.x, rect_max.y };
+}
+
+bool itu_lib_collide_segment_circle(vec2f segment_a, vec2f segment_b, vec2f circle_center, float circle_radius, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	vec2f closest = collide_closest_point_segment(circle_center, segment_a, segment_b);
+	vec2f v = circle_center - closest;
+	float d_sq = length_sq(v);
+	if(d_sq >= circle_radius * circle_radius)
+		return false;
+
+	// NOTE: the helper works from the circle point of view, so we flip the normal at the end
+	vec2f segment = segment_b - segment_a;
+	collide_fill_circle_point(circle_radius, -v, d_sq, vec2f{ segment.y, -segment.x }, closest, out_contact);
+	out_contact->normal = -out_contact->normal;
+	return true;
+}
+
+bool itu_lib_collide_segment_segment(vec2f segment_0_a, vec2f segment_0_b, vec2f segment_1_a, vec2f segment_1_b, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	vec2f vertices_0[2] = { segment_0_a, segment_0_b };
+	vec2f vertices_1[2] = { segment_1_a, segment_1_b };
+	return collide_sat(vertices_0, 2, vertices_1, 2, out_contact);
+}
+
+bool itu_lib_collide_segment_rect(vec2f segment_a, vec2f segment_b, vec2f rect_min, vec2f rect_max, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	vec2f segment_vertices[2] = { segment_a, segment_b };
+	vec2f rect_vertices[4];
+	collide_rect_vertices(rect_min, rect_max, rect_vertices);
+	return collide_sat(segment_vertices, 2, rect_vertices, 4, out_contact);
+}
+
+bool itu_lib_collide_circle_circle(vec2f circle_center_0, float circle_radius_0, vec2f circle_center_1, float circle_radius_1, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	vec2f v = circle_center_1 - circle_center_0;
+	float d_sq = length_sq(v);
+	float r_sum = circle_radius_0 + circle_radius_1;
+
+	// NOTE: same strict test as `itu_lib_overlaps_circle_circle()`
+	if(d_sq >= r_sum * r_sum)
+		return false;
+
+	collide_fill_circle_point(r_sum, v, d_sq, VEC2F_UP, circle_center_0, out_contact);
+	out_contact->point = circle_center_0 + out_contact->normal * (circle_radius_0 - out_contact->depth * 0.5f);
+	return true;
+}
+
+bool itu_lib_collide_circle_rect(vec2f circle_center, float circle_radius, vec2f rect_min, vec2f rect_max, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	vec2f closest = vec2f{ SDL_clamp(circle_center.x, rect_min.x, rect_max.x), SDL_clamp(circle_center.y, rect_min.y, rect_max.y) };
+	vec2f v = closest - circle_center;
+	float d_sq = length_sq(v);
+
+	if(d_sq > 0)
+	{
+		if(d_sq >= circle_radius * circle_radius)
+			return false;
+
+		collide_fill_circle_point(circle_radius, v, d_sq, VEC2F_UP, closest, out_contact);
+		return true;
+	}
+
+	// center inside the rect: push the circle out of the closest edge
+	float d_left   = circle_center.x - rect_min.x;
+	float d_right  = rect_max.x - circle_center.x;
+	float d_bottom = circle_center.y - rect_min.y;
+	float d_top    = rect_max.y - circle_center.y;
+	float d_min = SDL_min(SDL_min(d_left, d_right), SDL_min(d_bottom, d_top));
+
+	// NOTE: the circle must go *out* of the closest edge, so the normal (towards the rect) points the other way
+	if     (d_min == d_left)   { out_contact->normal = VEC2F_RIGHT; out_contact->point = vec2f{ rect_min.x, circle_center.y }; }
+	else if(d_min == d_right)  { out_contact->normal = VEC2F_LEFT;  out_contact->point = vec2f{ rect_max.x, circle_center.y }; }
+	else if(d_min == d_bottom) { out_contact->normal = VEC2F_UP;    out_contact->point = vec2f{ circle_center.x, rect_min.y }; }
+	else                       { out_contact->normal = VEC2F_DOWN;  out_contact->point = vec2f{ circle_center.x, rect_max.y }; }
+	out_contact->depth = circle_radius + d_min;
+	return true;
+}
+
+bool itu_lib_collide_rect_rect(vec2f rect_min_0, vec2f rect_max_0, vec2f rect_min_1, vec2f rect_max_1, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	// same as `collide_sat()`, but the axes are known: push rect 1 forward or backward along each of them, whichever is shorter
+	vec2f overlap_forward  = rect_max_0 - rect_min_1;
+	vec2f overlap_backward = rect_max_1 - rect_min_0;
+	vec2f overlap = vec2f{ SDL_min(overlap_forward.x, overlap_backward.x), SDL_min(overlap_forward.y, overlap_backward.y) };
+	if(overlap.x <= 0 || overlap.y <= 0)
+		return false;
+
+	if(overlap.x < overlap.y)
+	{
+		out_contact->normal = overlap_forward.x < overlap_backward.x ? VEC2F_RIGHT : VEC2F_LEFT;
+		out_contact->depth  = overlap.x;
+	}
+	else
+	{
+		out_contact->normal = overlap_forward.y < overlap_backward.y ? VEC2F_UP : VEC2F_DOWN;
+		out_contact->depth  = overlap.y;
+	}
+
+	// center of the intersection of the two rects
+	vec2f intersection_min = vec2f{ SDL_max(rect_min_0.x, rect_min_1.x), SDL_max(rect_min_0.y, rect_min_1.y) };
+	vec2f intersection_max = vec2f{ SDL_min(rect_max_0.x, rect_max_1.x), SDL_min(rect_max_0.y, rect_max_1.y) };
+	out_contact->point = (intersection_min + intersection_max) * 0.5f;
+	return true;
+}
+
+bool itu_lib_collide_segment_polygon(vec2f segment_a, vec2f segment_b, vec2f* polygon_vertices, int poligon_vertices_count, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	vec2f segment_vertices[2] = { segment_a, segment_b };
+	return collide_sat(segment_vertices, 2, polygon_vertices, poligon_vertices_count, out_contact);
+}
+
+bool itu_lib_collide_circle_polygon(vec2f circle_center, float circle_radius, vec2f* polygon_vertices, int poligon_vertices_count, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+	SDL_assert(polygon_vertices && poligon_vertices_count > 2);
+
+	// closest point on the polygon boundary, and whether the center is inside (on the left of all edges)
+	bool  inside = true;
+	vec2f closest = polygon_vertices[0];
+	float closest_d_sq = -1;
+	vec2f closest_edge = VEC2F_ZERO;
+	for(int i = 0; i < poligon_vertices_count; ++i)
+	{
+		vec2f a = polygon_vertices[i];
+		vec2f b = polygon_vertices[(i + 1) % poligon_vertices_count];
+		if(cross(b - a, circle_center - a) < 0)
+			inside = false;
+
+		vec2f p = collide_closest_point_segment(circle_center, a, b);
+		float d_sq = length_sq(p - circle_center);
+		if(closest_d_sq < 0 || d_sq < closest_d_sq)
+		{
+			closest_d_sq = d_sq;
+			closest = p;
+			closest_edge = b - a;
+		}
+	}
+
+	// NOTE: for CCW polygons, (edge.y, -edge.x) points outside
+	vec2f edge_outward = vec2f{ closest_edge.y, -closest_edge.x };
+	if(!inside)
+	{
+		if(closest_d_sq >= circle_radius * circle_radius)
+			return false;
+
+		collide_fill_circle_point(circle_radius, closest - circle_center, closest_d_sq, -edge_outward, closest, out_contact);
+		return true;
+	}
+
+	// center inside the polygon: the circle must go out through the closest edge, the normal points the other way
+	collide_fill_circle_point(circle_radius, circle_center - closest, closest_d_sq, -edge_outward, closest, out_contact);
+	out_contact->depth = 2 * circle_radius - out_contact->depth; // the helper gives us `r - d`, we need `r + d`
+	return true;
+}
+
+bool itu_lib_collide_rect_polygon(vec2f rect_min, vec2f rect_max, vec2f* polygon_vertices, int poligon_vertices_count, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	vec2f rect_vertices[4];
+	collide_rect_vertices(rect_min, rect_max, rect_vertices);
+	return collide_sat(rect_vertices, 4, polygon_vertices, poligon_vertices_count, out_contact);
+}
+
+bool itu_lib_collide_polygon_polygon(vec2f* polygon_0_vertices, int poligon_0_vertices_count, vec2f* polygon_1_vertices, int poligon_1_vertices_count, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	return collide_sat(polygon_0_vertices, poligon_0_vertices_count, polygon_1_vertices, poligon_1_vertices_count, out_contact);
+}
+
+// *******************************************************************
+// convex polygons with cached edge data
+// *******************************************************************
+
+void itu_lib_overlaps_convex_polygon_init(ConvexPolygon* polygon, vec2f* vertices, vec2f* normals, int vertices_count)
+{
+	SDL_assert(polygon);
+	SDL_assert(vertices && normals && vertices_count >= 3);
+
+	polygon->vertices       = vertices;
+	polygon->normals        = normals;
+	polygon->vertices_count = vertices_count;
+
+	polygon->aabb_min = vertices[0];
+	polygon->aabb_max = vertices[0];
+	for(int i = 0; i < vertices_count; ++i)
+	{
+		vec2f a = vertices[i];
+		vec2f b = vertices[(i + 1) % vertices_count];
+		normals[i] = normalize(vec2f{ b.y - a.y, a.x - b.x });
+
+		polygon->aabb_min = vec2f{ SDL_min(polygon->aabb_min.x, a.x), SDL_min(polygon->aabb_min.y, a.y) };
+		polygon->aabb_max = vec2f{ SDL_max(polygon->aabb_max.x, a.x), SDL_max(polygon->aabb_max.y, a.y) };
+	}
+
+	// NOTE: same approximation as `itu_lib_overlaps_shape_polygon()`
+	polygon->bounding_center = (polygon->aabb_min + polygon->aabb_max) * 0.5f;
+	float radius_sq = 0;
+	for(int i = 0; i < vertices_count; ++i)
+		radius_sq = SDL_max(radius_sq, length_sq(vertices[i] - polygon->bounding_center));
+	polygon->bounding_radius = SDL_sqrtf(radius_sq);
+}
+
+static inline bool convex_polygon_bounds(ConvexPolygon* polygon_0, ConvexPolygon* polygon_1)
+{
+	return
+		itu_lib_overlaps_rect_rect(polygon_0->aabb_min, polygon_0->aabb_max, polygon_1->aabb_min, polygon_1->aabb_max) &&
+		itu_lib_overlaps_circle_circle(polygon_0->bounding_center, polygon_0->bounding_radius, polygon_1->bounding_center, polygon_1->bounding_radius);
+}
+
+// largest separation of `polygon_1` from `polygon_0`, along the normals of `polygon_0` (see `itu_lib_overlaps_convex_polygon_separation()`)
+// NOTE: the deepest vertex of polygon_1 along -normal only moves forward (CCW) as we go around polygon_0's normals (also CCW),
+//       so instead of checking all of polygon_1's vertices for every normal we keep climbing from the last one.
+//       That makes the whole test O(N+M) instead of O(N*M)
+static float convex_polygon_max_separation(ConvexPolygon* polygon_0, ConvexPolygon* polygon_1, bool stop_if_separated, int* out_edge_idx, int* out_vertex_idx)
+{
+	vec2f* vertices_1 = polygon_1->vertices;
+	int    count_1    = polygon_1->vertices_count;
+
+	// deepest vertex for the first normal, the hard way
+	int   vertex_idx = 0;
+	float vertex_p   = dot(vertices_1[0], polygon_0->normals[0]);
+	for(int j = 1; j < count_1; ++j)
+	{
+		float p = dot(vertices_1[j], polygon_0->normals[0]);
+		if(p < vertex_p)
+		{
+			vertex_p = p;
+			vertex_idx = j;
+		}
+	}
+
+	float best_separation = -SDL_MAX_SINT32;
+	int   best_edge_idx   = 0;
+	int   best_vertex_idx = 0;
+	for(int i = 0; i < polygon_0->vertices_count; ++i)
+	{
+		vec2f normal = polygon_0->normals[i];
+
+		// NOTE: `<=` walks over flat runs (collinear or duplicate vertices), the counter stops us from going around forever
+		for(int steps = 0; steps < count_1; ++steps)
+		{
+			int next = (vertex_idx + 1) % count_1;
+			if(dot(vertices_1[next], normal) > dot(vertices_1[vertex_idx], normal))
+				break;
+			vertex_idx = next;
+		}
+
+		float separation = dot(vertices_1[vertex_idx] - polygon_0->vertices[i], normal);
+		if(separation > best_separation)
+		{
+			best_separation = separation;
+			best_edge_idx   = i;
+			best_vertex_idx = vertex_idx;
+		}
+
+		if(stop_if_separated && separation >= 0)
+			break;
+	}
+
+	if(out_edge_idx)
+		*out_edge_idx = best_edge_idx;
+	if(out_vertex_idx)
+		*out_vertex_idx = best_vertex_idx;
+	return best_separation;
+}
+
+// SAT helper: how far `polygon_1` is from `polygon_0` along the best of `polygon_0`'s normals (positive means separated, negative is the penetration)
+// `out_edge_idx` gets that edge of polygon_0, `out_vertex_idx` the vertex of polygon_1 closest to it (both can be NULL)
+// NOTE: it only checks one set of axes, a full SAT test needs to call it again with the polygons swapped
+float itu_lib_overlaps_convex_polygon_separation(ConvexPolygon* polygon_0, ConvexPolygon* polygon_1, int* out_edge_idx, int* out_vertex_idx)
+{
+	SDL_assert(polygon_0 && polygon_1);
+	return convex_polygon_max_separation(polygon_0, polygon_1, false, out_edge_idx, out_vertex_idx);
+}
+
+// O(log(N)) point test: binary search for the "wedge" (the triangle fan from vertex 0) that contains the point, then one edge test
+// NOTE: strict test, points on the edges are not inside
+bool itu_lib_overlaps_point_convex_polygon(vec2f point, ConvexPolygon* polygon)
+{
+	SDL_assert(polygon);
+
+	if(!itu_lib_overlaps_point_rect(point, polygon->aabb_min, polygon->aabb_max))
+		return false;
+
+	vec2f* vertices = polygon->vertices;
+	int    count    = polygon->vertices_count;
+	vec2f  p        = point - vertices[0];
+
+	// outside the fan altogether
+	if(cross(vertices[1] - vertices[0], p) <= 0 || cross(vertices[count - 1] - vertices[0], p) >= 0)
+		return false;
+
+	// find the wedge (vertices[0], vertices[lo], vertices[lo + 1]) containing the point
+	int lo = 1;
+	int hi = count - 1;
+	while(hi - lo > 1)
+	{
+		int mid = (lo + hi) / 2;
+		if(cross(vertices[mid] - vertices[0], p) >= 0)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	return cross(vertices[lo + 1] - vertices[lo], point - vertices[lo]) > 0;
+}
+
+// NOTE: the edge the circle center is farthest out from tells us which feature is the closest: that edge, or one of its vertices
+static bool convex_polygon_circle(vec2f circle_center, float circle_radius, ConvexPolygon* polygon, Contact* out_contact)
+{
+	if(!itu_lib_overlaps_circle_circle(circle_center, circle_radius, polygon->bounding_center, polygon->bounding_radius))
+		return false;
+
+	float best_separation = -SDL_MAX_SINT32;
+	int   best_edge_idx   = 0;
+	for(int i = 0; i < polygon->vertices_count; ++i)
+	{
+		float separation = dot(circle_center - polygon->vertices[i], polygon->normals[i]);
+		if(separation >= circle_radius)
+			return false;
+		if(separation > best_separation)
+		{
+			best_separation = separation;
+			best_edge_idx   = i;
+		}
+	}
+
+	vec2f a = polygon->vertices[best_edge_idx];
+	vec2f b = polygon->vertices[(best_edge_idx + 1) % polygon->vertices_count];
+	vec2f normal = polygon->normals[best_edge_idx];
+
+	// center inside the polygon, or in front of the edge: the edge is the closest feature
+	if(best_separation < 0 || (dot(circle_center - a, b - a) > 0 && dot(circle_center - b, a - b) > 0))
+	{
+		if(out_contact)
+		{
+			// NOTE: normal goes from the circle to the polygon
+			out_contact->normal = -normal;
+			out_contact->depth  = circle_radius - best_separation;
+			out_contact->point  = circle_center - normal * ((best_separation + circle_radius) * 0.5f);
+		}
+		return true;
+	}
+
+	// closest to one of the vertices
+	vec2f vertex = dot(circle_center - a, b - a) <= 0 ? a : b;
+	vec2f dir = vertex - circle_center;
+	float d_sq = length_sq(dir);
+	if(d_sq >= circle_radius * circle_radius)
+		return false;
+
+	if(out_contact)
+		collide_fill_circle_point(circle_radius, dir, d_sq, -normal, vertex, out_contact);
+	return true;
+}
+
+bool itu_lib_overlaps_circle_convex_polygon(vec2f circle_center, float circle_radius, ConvexPolygon* polygon)
+{
+	SDL_assert(polygon);
+	return convex_polygon_circle(circle_center, circle_radius, polygon, NULL);
+}
+
+bool itu_lib_collide_circle_convex_polygon(vec2f circle_center, float circle_radius, ConvexPolygon* polygon, Contact* out_contact)
+{
+	SDL_assert(polygon);
+	SDL_assert(out_contact);
+	return convex_polygon_circle(circle_center, circle_radius, polygon, out_contact);
+}
+
+bool itu_lib_overlaps_convex_polygon_convex_polygon(ConvexPolygon* polygon_0, ConvexPolygon* polygon_1)
+{
+	SDL_assert(polygon_0 && polygon_1);
+
+	if(!convex_polygon_bounds(polygon_0, polygon_1))
+		return false;
+
+	// NOTE: strict test, touching polygons (separation 0) don't overlap
+	return
+		convex_polygon_max_separation(polygon_0, polygon_1, true, NULL, NULL) < 0 &&
+		convex_polygon_max_separation(polygon_1, polygon_0, true, NULL, NULL) < 0;
+}
+
+bool itu_lib_collide_convex_polygon_convex_polygon(ConvexPolygon* polygon_0, ConvexPolygon* polygon_1, Contact* out_contact)
+{
+	SDL_assert(polygon_0 && polygon_1);
+	SDL_assert(out_contact);
+
+	if(!convex_polygon_bounds(polygon_0, polygon_1))
+		return false;
+
+	int edge_0, vertex_1;
+	float separation_0 = convex_polygon_max_separation(polygon_0, polygon_1, true, &edge_0, &vertex_1);
+	if(separation_0 >= 0)
+		return false;
+
+	int edge_1, vertex_0;
+	float separation_1 = convex_polygon_max_separation(polygon_1, polygon_0, true, &edge_1, &vertex_0);
+	if(separation_1 >= 0)
+		return false;
+
+	// the axis with the smallest penetration wins. The deepest vertex, moved back by half the depth, is the contact point
+	if(separation_0 >= separation_1)
+	{
+		out_contact->normal = polygon_0->normals[edge_0];
+		out_contact->depth  = -separation_0;
+		out_contact->point  = polygon_1->vertices[vertex_1] + out_contact->normal * (out_contact->depth * 0.5f);
+	}
+	else
+	{
+		out_contact->normal = -polygon_1->normals[edge_1];
+		out_contact->depth  = -separation_1;
+		out_contact->point  = polygon_0->vertices[vertex_0] - out_contact->normal * (out_contact->depth * 0.5f);
+	}
+	return true;
+}
+
+// *******************************************************************
+// OBBs and capsules
+// NOTE: every pair starts with a bounding circle test, which is much cheaper than the real one and rejects most pairs
+// *******************************************************************
+
+OBB itu_lib_overlaps_obb_make(vec2f obb_center, vec2f obb_half_extents, float obb_rotation)
+{
+	OBB ret;
+	ret.center       = obb_center;
+	ret.half_extents = obb_half_extents;
+	ret.axis_x       = vec2f{ SDL_cosf(obb_rotation), SDL_sinf(obb_rotation) };
+	return ret;
+}
+
+static inline vec2f obb_axis_y(OBB* obb)
+{
+	return vec2f{ -obb->axis_x.y, obb->axis_x.x };
+}
+
+// world space point -> OBB space point (where the OBB is the rect [-half_extents, half_extents])
+static inline vec2f obb_to_local(OBB* obb, vec2f point)
+{
+	vec2f d = point - obb->center;
+	return vec2f{ dot(d, obb->axis_x), dot(d, obb_axis_y(obb)) };
+}
+
+// OBB space direction -> world space direction
+static inline vec2f obb_to_world_direction(OBB* obb, vec2f direction)
+{
+	return obb->axis_x * direction.x + obb_axis_y(obb) * direction.y;
+}
+
+// CCW vertices of an OBB
+static inline void obb_vertices(OBB* obb, vec2f* out_vertices)
+{
+	vec2f x = obb->axis_x * obb->half_extents.x;
+	vec2f y = obb_axis_y(obb) * obb->half_extents.y;
+	out_vertices[0] = obb->center - x - y;
+	out_vertices[1] = obb->center + x - y;
+	out_vertices[2] = obb->center + x + y;
+	out_vertices[3] = obb->center - x + y;
+}
+
+static inline OBB obb_from_rect(vec2f rect_min, vec2f rect_max)
+{
+	OBB ret;
+	ret.half_extents = (rect_max - rect_min) * 0.5f;
+	ret.center       = rect_min + ret.half_extents;
+	ret.axis_x       = VEC2F_RIGHT;
+	return ret;
+}
+
+static inline bool obb_bounds(OBB* obb, vec2f center, float radius)
+{
+	return itu_lib_overlaps_circle_circle(obb->center, length(obb->half_extents), center, radius);
+}
+
+static inline bool capsule_bounds(vec2f capsule_a, vec2f capsule_b, float capsule_radius, vec2f center, float radius)
+{
+	vec2f capsule_center = (capsule_a + capsule_b) * 0.5f;
+	return itu_lib_overlaps_circle_circle(capsule_center, length(capsule_b - capsule_center) + capsule_radius, center, radius);
+}
+
+// plain polygons have no bounding circle cached, and computing one takes two passes over the vertices.
+// Testing the other shape's bounding circle against the polygon's AABB takes one, and rejects at least as much
+static inline bool polygon_bounds(vec2f* polygon_vertices, int poligon_vertices_count, vec2f center, float radius)
+{
+	vec2f min = polygon_vertices[0];
+	vec2f max = polygon_vertices[0];
+	for(int i = 1; i < poligon_vertices_count; ++i)
+	{
+		min = vec2f{ SDL_min(min.x, polygon_vertices[i].x), SDL_min(min.y, polygon_vertices[i].y) };
+		max = vec2f{ SDL_max(max.x, polygon_vertices[i].x), SDL_max(max.y, polygon_vertices[i].y) };
+	}
+	return itu_lib_overlaps_circle_rect(center, radius, min, max);
+}
+
+// closest pair of points between two convex vertex lists that don't overlap (a list of 2 vertices is a segment), returns their distance^2
+// `out_edge_normal` gets the normal (from list 0 to list 1) of the edge the closest pair lies on, for when the points are too close to give a direction
+// NOTE: when they are apart, the closest pair always has a vertex on one side. Brute force, fine for the small lists we use this for
+static float collide_closest_points(vec2f* vertices_0, int vertices_count_0, vec2f* vertices_1, int vertices_count_1, vec2f* out_point_0, vec2f* out_point_1, vec2f* out_edge_normal)
+{
+	float best_d_sq = -1;
+	int   best_list = 0;
+	int   best_edge = 0;
+	for(int list = 0; list < 2; ++list)
+	{
+		vec2f* vertices       = list == 0 ? vertices_0       : vertices_1;
+		int    vertices_count = list == 0 ? vertices_count_0 : vertices_count_1;
+		vec2f* edges          = list == 0 ? vertices_1       : vertices_0;
+		int    edges_count    = list == 0 ? vertices_count_1 : vertices_count_0;
+
+		for(int i = 0; i < vertices_count; ++i)
+		{
+			for(int j = 0; j < (edges_count == 2 ? 1 : edges_count); ++j)
+			{
+				vec2f closest = collide_closest_point_segment(vertices[i], edges[j], edges[(j + 1) % edges_count]);
+				float d_sq = length_sq(closest - vertices[i]);
+				if(best_d_sq < 0 || d_sq < best_d_sq)
+				{
+					best_d_sq = d_sq;
+					best_list = list;
+					best_edge = j;
+					*out_point_0 = list == 0 ? vertices[i] : closest;
+					*out_point_1 = list == 0 ? closest     : vertices[i];
+				}
+			}
+		}
+	}
+
+	// outward normal of the edge (for a segment, the side facing the other list)
+	vec2f* edges       = best_list == 0 ? vertices_1       : vertices_0;
+	int    edges_count = best_list == 0 ? vertices_count_1 : vertices_count_0;
+	vec2f* others      = best_list == 0 ? vertices_0       : vertices_1;
+	vec2f  edge_a = edges[best_edge];
+	vec2f  edge_b = edges[(best_edge + 1) % edges_count];
+	vec2f  normal = normalize(vec2f{ edge_b.y - edge_a.y, edge_a.x - edge_b.x });
+	if(edges_count == 2 && dot(normal, others[0] + others[1] - edge_a - edge_b) < 0)
+		normal = -normal;
+
+	// the edge belongs to list 1 when the vertex is in list 0, and its outward normal points towards list 0
+	*out_edge_normal = best_list == 0 ? -normal : normal;
+	return best_d_sq;
+}
+
+// contact between two convex vertex lists, each one "inflated" by a radius (0 for sharp shapes)
+// - cores overlapping: SAT on the cores, then the radii are added to the depth
+//   (inflating a shape by r moves its whole boundary out by r, so the penetration grows by exactly r)
+// - cores apart: closest points between the cores, compared against the sum of the radii
+static bool collide_rounded(vec2f* vertices_0, int vertices_count_0, float radius_0, vec2f* vertices_1, int vertices_count_1, float radius_1, Contact* out_contact)
+{
+	if(collide_sat(vertices_0, vertices_count_0, vertices_1, vertices_count_1, out_contact))
+	{
+		out_contact->depth += radius_0 + radius_1;
+		out_contact->point  = out_contact->point + out_contact->normal * ((radius_0 - radius_1) * 0.5f);
+		return true;
+	}
+
+	float r_sum = radius_0 + radius_1;
+	if(r_sum <= 0)
+		return false;
+
+	vec2f point_0     = VEC2F_ZERO;
+	vec2f point_1     = VEC2F_ZERO;
+	vec2f edge_normal = VEC2F_ZERO;
+	float d_sq = collide_closest_points(vertices_0, vertices_count_0, vertices_1, vertices_count_1, &point_0, &point_1, &edge_normal);
+	if(d_sq >= r_sum * r_sum)
+		return false;
+
+	// NOTE: when the cores are (almost) touching, the direction between the closest points is mostly rounding errors.
+	//       The normal of the edge they are on is the same direction, minus the noise
+	vec2f dir = point_1 - point_0;
+	if(d_sq < FLOAT_EPSILON * FLOAT_EPSILON)
+		dir = edge_normal * SDL_sqrtf(d_sq);
+	collide_fill_circle_point(r_sum, dir, d_sq, edge_normal, point_0, out_contact);
+	out_contact->point = point_0 + out_contact->normal * (radius_0 - out_contact->depth * 0.5f);
+	return true;
+}
+
+bool itu_lib_overlaps_point_capsule(vec2f point, vec2f capsule_a, vec2f capsule_b, float capsule_radius)
+{
+	vec2f closest = collide_closest_point_segment(point, capsule_a, capsule_b);
+	return itu_lib_overlaps_point_circle(point, closest, capsule_radius);
+}
+
+bool itu_lib_collide_segment_capsule(vec2f segment_a, vec2f segment_b, vec2f capsule_a, vec2f capsule_b, float capsule_radius, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	vec2f segment_center = (segment_a + segment_b) * 0.5f;
+	if(!capsule_bounds(capsule_a, capsule_b, capsule_radius, segment_center, length(segment_b - segment_center)))
+		return false;
+
+	vec2f segment_vertices[2] = { segment_a, segment_b };
+	vec2f capsule_vertices[2] = { capsule_a, capsule_b };
+	return collide_rounded(segment_vertices, 2, 0, capsule_vertices, 2, capsule_radius, out_contact);
+}
+
+bool itu_lib_overlaps_segment_capsule(vec2f segment_a, vec2f segment_b, vec2f capsule_a, vec2f capsule_b, float capsule_radius)
+{
+	Contact contact;
+	return itu_lib_collide_segment_capsule(segment_a, segment_b, capsule_a, capsule_b, capsule_radius, &contact);
+}
+
+// NOTE: a circle against a capsule is a circle against the closest point of the capsule's core
+bool itu_lib_collide_circle_capsule(vec2f circle_center, float circle_radius, vec2f capsule_a, vec2f capsule_b, float capsule_radius, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	vec2f closest = collide_closest_point_segment(circle_center, capsule_a, capsule_b);
+	return itu_lib_collide_circle_circle(circle_center, circle_radius, closest, capsule_radius, out_contact);
+}
+
+bool itu_lib_overlaps_circle_capsule(vec2f circle_center, float circle_radius, vec2f capsule_a, vec2f capsule_b, float capsule_radius)
+{
+	vec2f closest = collide_closest_point_segment(circle_center, capsule_a, capsule_b);
+	return itu_lib_overlaps_circle_circle(circle_center, circle_radius, closest, capsule_radius);
+}
+
+bool itu_lib_collide_capsule_capsule(vec2f capsule_0_a, vec2f capsule_0_b, float capsule_0_radius, vec2f capsule_1_a, vec2f capsule_1_b, float capsule_1_radius, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	vec2f capsule_1_center = (capsule_1_a + capsule_1_b) * 0.5f;
+	if(!capsule_bounds(capsule_0_a, capsule_0_b, capsule_0_radius, capsule_1_center, length(capsule_1_b - capsule_1_center) + capsule_1_radius))
+		return false;
+
+	vec2f capsule_0_vertices[2] = { capsule_0_a, capsule_0_b };
+	vec2f capsule_1_vertices[2] = { capsule_1_a, capsule_1_b };
+	return collide_rounded(capsule_0_vertices, 2, capsule_0_radius, capsule_1_vertices, 2, capsule_1_radius, out_contact);
+}
+
+bool itu_lib_overlaps_capsule_capsule(vec2f capsule_0_a, vec2f capsule_0_b, float capsule_0_radius, vec2f capsule_1_a, vec2f capsule_1_b, float capsule_1_radius)
+{
+	Contact contact;
+	return itu_lib_collide_capsule_capsule(capsule_0_a, capsule_0_b, capsule_0_radius, capsule_1_a, capsule_1_b, capsule_1_radius, &contact);
+}
+
+bool itu_lib_collide_capsule_rect(vec2f capsule_a, vec2f capsule_b, float capsule_radius, vec2f rect_min, vec2f rect_max, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	vec2f rect_center = (rect_min + rect_max) * 0.5f;
+	if(!capsule_bounds(capsule_a, capsule_b, capsule_radius, rect_center, length(rect_max - rect_center)))
+		return false;
+
+	vec2f capsule_vertices[2] = { capsule_a, capsule_b };
+	vec2f rect_vertices[4];
+	collide_rect_vertices(rect_min, rect_max, rect_vertices);
+	return collide_rounded(capsule_vertices, 2, capsule_radius, rect_vertices, 4, 0, out_contact);
+}
+
+bool itu_lib_overlaps_capsule_rect(vec2f capsule_a, vec2f capsule_b, float capsule_radius, vec2f rect_min, vec2f rect_max)
+{
+	Contact contact;
+	return itu_lib_collide_capsule_rect(capsule_a, capsule_b, capsule_radius, rect_min, rect_max, &contact);
+}
+
+bool itu_lib_collide_capsule_obb(vec2f capsule_a, vec2f capsule_b, float capsule_radius, OBB obb, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	if(!capsule_bounds(capsule_a, capsule_b, capsule_radius, obb.center, length(obb.half_extents)))
+		return false;
+
+	vec2f capsule_vertices[2] = { capsule_a, capsule_b };
+	vec2f obb_vertices_[4];
+	obb_vertices(&obb, obb_vertices_);
+	return collide_rounded(capsule_vertices, 2, capsule_radius, obb_vertices_, 4, 0, out_contact);
+}
+
+bool itu_lib_overlaps_capsule_obb(vec2f capsule_a, vec2f capsule_b, float capsule_radius, OBB obb)
+{
+	Contact contact;
+	return itu_lib_collide_capsule_obb(capsule_a, capsule_b, capsule_radius, obb, &contact);
+}
+
+bool itu_lib_collide_capsule_polygon(vec2f capsule_a, vec2f capsule_b, float capsule_radius, vec2f* polygon_vertices, int poligon_vertices_count, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+	SDL_assert(polygon_vertices);
+
+	vec2f capsule_center = (capsule_a + capsule_b) * 0.5f;
+	if(!polygon_bounds(polygon_vertices, poligon_vertices_count, capsule_center, length(capsule_b - capsule_center) + capsule_radius))
+		return false;
+
+	vec2f capsule_vertices[2] = { capsule_a, capsule_b };
+	return collide_rounded(capsule_vertices, 2, capsule_radius, polygon_vertices, poligon_vertices_count, 0, out_contact);
+}
+
+bool itu_lib_overlaps_capsule_polygon(vec2f capsule_a, vec2f capsule_b, float capsule_radius, vec2f* polygon_vertices, int poligon_vertices_count)
+{
+	Contact contact;
+	return itu_lib_collide_capsule_polygon(capsule_a, capsule_b, capsule_radius, polygon_vertices, poligon_vertices_count, &contact);
+}
+
+bool itu_lib_overlaps_point_obb(vec2f point, OBB obb)
+{
+	vec2f p = obb_to_local(&obb, point);
+	return SDL_fabsf(p.x) < obb.half_extents.x && SDL_fabsf(p.y) < obb.half_extents.y;
+}
+
+// NOTE: tests against OBBs are done in the OBB's space (where it's just a rect), and the result is moved back to world space
+bool itu_lib_overlaps_segment_obb(vec2f segment_a, vec2f segment_b, OBB obb)
+{
+	return itu_lib_overlaps_segment_rect(obb_to_local(&obb, segment_a), obb_to_local(&obb, segment_b), -obb.half_extents, obb.half_extents);
+}
+
+bool itu_lib_collide_segment_obb(vec2f segment_a, vec2f segment_b, OBB obb, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	if(!itu_lib_collide_segment_rect(obb_to_local(&obb, segment_a), obb_to_local(&obb, segment_b), -obb.half_extents, obb.half_extents, out_contact))
+		return false;
+
+	out_contact->normal = obb_to_world_direction(&obb, out_contact->normal);
+	out_contact->point  = obb.center + obb_to_world_direction(&obb, out_contact->point);
+	return true;
+}
+
+bool itu_lib_overlaps_circle_obb(vec2f circle_center, float circle_radius, OBB obb)
+{
+	return itu_lib_overlaps_circle_rect(obb_to_local(&obb, circle_center), circle_radius, -obb.half_extents, obb.half_extents);
+}
+
+bool itu_lib_collide_circle_obb(vec2f circle_center, float circle_radius, OBB obb, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	if(!itu_lib_collide_circle_rect(obb_to_local(&obb, circle_center), circle_radius, -obb.half_extents, obb.half_extents, out_contact))
+		return false;
+
+	out_contact->normal = obb_to_world_direction(&obb, out_contact->normal);
+	out_contact->point  = obb.center + obb_to_world_direction(&obb, out_contact->point);
+	return true;
+}
+
+// SAT with only 4 axes (2 per OBB, opposite edges share the same one).
+// The projection of an OBB on a normalized axis is its center +- the projection of its half extents
+bool itu_lib_collide_obb_obb(OBB obb_0, OBB obb_1, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+
+	if(!obb_bounds(&obb_0, obb_1.center, length(obb_1.half_extents)))
+		return false;
+
+	vec2f axes[4] = { obb_0.axis_x, obb_axis_y(&obb_0), obb_1.axis_x, obb_axis_y(&obb_1) };
+	vec2f d = obb_1.center - obb_0.center;
+
+	float best_overlap = -1;
+	vec2f best_axis    = VEC2F_ZERO;
+	for(int i = 0; i < 4; ++i)
+	{
+		vec2f axis = axes[i];
+		float r_0 = obb_0.half_extents.x * SDL_fabsf(dot(axes[0], axis)) + obb_0.half_extents.y * SDL_fabsf(dot(axes[1], axis));
+		float r_1 = obb_1.half_extents.x * SDL_fabsf(dot(axes[2], axis)) + obb_1.half_extents.y * SDL_fabsf(dot(axes[3], axis));
+		float distance = dot(d, axis);
+
+		// NOTE: strict test, same as the overlap functions
+		float overlap = r_0 + r_1 - SDL_fabsf(distance);
+		if(overlap <= 0)
+			return false;
+
+		if(best_overlap < 0 || overlap < best_overlap)
+		{
+			best_overlap = overlap;
+			best_axis    = distance < 0 ? -axis : axis;
+		}
+	}
+
+	// deepest point of obb_1 (its support point along -normal), moved back by half the depth
+	vec2f deepest = obb_1.center
+		- axes[2] * (obb_1.half_extents.x * (dot(axes[2], best_axis) < 0 ? -1.0f : 1.0f))
+		- axes[3] * (obb_1.half_extents.y * (dot(axes[3], best_axis) < 0 ? -1.0f : 1.0f));
+
+	out_contact->normal = best_axis;
+	out_contact->depth  = best_overlap;
+	out_contact->point  = deepest + best_axis * (best_overlap * 0.5f);
+	return true;
+}
+
+bool itu_lib_overlaps_obb_obb(OBB obb_0, OBB obb_1)
+{
+	Contact contact;
+	return itu_lib_collide_obb_obb(obb_0, obb_1, &contact);
+}
+
+bool itu_lib_collide_rect_obb(vec2f rect_min, vec2f rect_max, OBB obb, Contact* out_contact)
+{
+	return itu_lib_collide_obb_obb(obb_from_rect(rect_min, rect_max), obb, out_contact);
+}
+
+bool itu_lib_overlaps_rect_obb(vec2f rect_min, vec2f rect_max, OBB obb)
+{
+	Contact contact;
+	return itu_lib_collide_obb_obb(obb_from_rect(rect_min, rect_max), obb, &contact);
+}
+
+bool itu_lib_collide_obb_polygon(OBB obb, vec2f* polygon_vertices, int poligon_vertices_count, Contact* out_contact)
+{
+	SDL_assert(out_contact);
+	SDL_assert(polygon_vertices);
+
+	if(!polygon_bounds(polygon_vertices, poligon_vertices_count, obb.center, length(obb.half_extents)))
+		return false;
+
+	vec2f obb_vertices_[4];
+	obb_vertices(&obb, obb_vertices_);
+	return collide_sat(obb_vertices_, 4, polygon_vertices, poligon_vertices_count, out_contact);
+}
+
+bool itu_lib_overlaps_obb_polygon(OBB obb, vec2f* polygon_vertices, int poligon_vertices_count)
+{
+	Contact contact;
+	return itu_lib_collide_obb_polygon(obb, polygon_vertices, poligon_vertices_count, &contact);
+}
+
+// max vertices of the polytope built by EPA (each iteration adds one, so this is also the max number of iterations)
+#define ITU_LIB_OVERLAPS_EPA_VERTICES_MAX 64
+
+// normal and distance from the origin of the polytope edge that starts from vertex `i`
+static void epa_compute_edge(vec2f* polytope, int polytope_count, int i, vec2f* edge_normals, float* edge_distances)
+{
+	vec2f a = polytope[i];
+	vec2f b = polytope[(i + 1) % polytope_count];
+	vec2f edge = b - a;
+	float edge_len = SDL_sqrtf(length_sq(edge));
+
+	// NOTE: degenerate edges get a negative distance, so they are never picked
+	edge_normals[i]   = edge_len > 0 ? vec2f{ edge.y, -edge.x } / edge_len : VEC2F_ZERO;
+	edge_distances[i] = edge_len > 0 ? dot(edge_normals[i], a) : -1;
+}
+
+// Expanding Polytope Algorithm: starting from the simplex found by GJK (which contains the origin),
+// keeps pushing out the edge closest to the origin until it lies on the border of the Minkowski difference.
+// That edge gives the minimum translation vector (`normal * depth`)
+// NOTE: returns false if the simplex is degenerate (ie, the polygons are just touching)
+// NOTE: round shapes have no edges, so the polytope only gets within `FLOAT_EPSILON` of their border (or stops at `ITU_LIB_OVERLAPS_EPA_VERTICES_MAX` vertices)
+bool itu_lib_collide_epa(Shape* shape_0, Shape* shape_1, vec2f* simplex, int simplex_count, Contact* out_contact)
+{
+	SDL_assert(shape_0);
+	SDL_assert(shape_1);
+	SDL_assert(simplex);
+	SDL_assert(out_contact);
+
+	if(simplex_count < 3)
+		return false;
+
+	// polytope vertices, and normal/distance from the origin of the edge that starts from each of them
+	// NOTE: we keep the edges cached, so every iteration only pays the square roots of the two new edges
+	vec2f polytope[ITU_LIB_OVERLAPS_EPA_VERTICES_MAX];
+	vec2f edge_normals[ITU_LIB_OVERLAPS_EPA_VERTICES_MAX];
+	float edge_distances[ITU_LIB_OVERLAPS_EPA_VERTICES_MAX];
+	int polytope_count = 3;
+
+	// make sure the triangle is CCW, so (edge.y, -edge.x) points outside
+	polytope[0] = simplex[0];
+	polytope[1] = simplex[1];
+	polytope[2] = simplex[2];
+	float winding = cross(polytope[1] - polytope[0], polytope[2] - polytope[0]);
+	if(winding == 0)
+		return false;
+	if(winding < 0)
+	{
+		polytope[1] = simplex[2];
+		polytope[2] = simplex[1];
+	}
+
+	for(int i = 0; i < polytope_count; ++i)
+		epa_compute_edge(polytope, polytope_count, i, edge_normals, edge_distances);
+
+	int closest = -1;
+	for(;;)
+	{
+		closest = -1;
+		for(int i = 0; i < polytope_count; ++i)
+			if(edge_distances[i] >= 0 && (closest < 0 || edge_distances[i] < edge_distances[closest]))
+				closest = i;
+		if(closest < 0)
+			return false;
+
+		vec2f normal = edge_normals[closest];
+		vec2f support = gjk_support(shape_0, shape_1, normal);
+
+		// the edge is already on the border, can't expand any further
+		if(dot(support, normal) - edge_distances[closest] < FLOAT_EPSILON || polytope_count == ITU_LIB_OVERLAPS_EPA_VERTICES_MAX)
+			break;
+
+		// insert the support point between the two vertices of the edge, and recompute the two edges it creates
+		for(int i = polytope_count; i > closest + 1; --i)
+		{
+			polytope[i]       = polytope[i - 1];
+			edge_normals[i]   = edge_normals[i - 1];
+			edge_distances[i] = edge_distances[i - 1];
+		}
+		polytope[closest + 1] = support;
+		polytope_count++;
+		epa_compute_edge(polytope, polytope_count, closest,     edge_normals, edge_distances);
+		epa_compute_edge(polytope, polytope_count, closest + 1, edge_normals, edge_distances);
+	}
+
+	// NOTE: the Minkowski difference is shape 0 - shape 1, so the normal of the closest edge already goes from shape 0 to shape 1
+	out_contact->normal = edge_normals[closest];
+	out_contact->depth  = edge_distances[closest];
+
+	// deepest point of shape 1 inside shape 0, moved back by half the depth (same as `collide_sat()`)
+	vec2f deepest = itu_lib_overlaps_shape_support(shape_1, -out_contact->normal);
+	out_contact->point = deepest + out_contact->normal * (out_contact->depth * 0.5f);
+	return out_contact->depth > 0;
+}
+
+// EPA for two polygons, starting from the simplex given by `itu_lib_overlaps_polygon_polygon()`
+bool itu_lib_collide_polygon_polygon_epa(vec2f* polygon_0_vertices, int poligon_0_vertices_count, vec2f* polygon_1_vertices, int poligon_1_vertices_count, vec2f* simplex, int simplex_count, Contact* out_contact)
+{
+	SDL_assert(polygon_0_vertices);
+	SDL_assert(polygon_1_vertices);
+
+	Shape shape_0 = shape_polygon_identity(polygon_0_vertices, poligon_0_vertices_count);
+	Shape shape_1 = shape_polygon_identity(polygon_1_vertices, poligon_1_vertices_count);
+	return itu_lib_collide_epa(&shape_0, &shape_1, simplex, simplex_count, out_contact);
+}
+
+// contact test between any two shapes
+// `cache` can be NULL, see `GJKCache`
+bool itu_lib_collide_shape_shape(Shape* shape_0, Shape* shape_1, GJKCache* cache, Contact* out_contact)
+{
+	SDL_assert(shape_0);
+	SDL_assert(shape_1);
+	SDL_assert(out_contact);
+
+	if(!itu_lib_overlaps_shape_bounds(shape_0, shape_1))
+		return false;
+
+	// NOTE: circles are common enough (and EPA slow enough on round shapes) to deserve their own path
+	if(shape_0->type == SHAPE_TYPE_CIRCLE && shape_1->type == SHAPE_TYPE_CIRCLE)
+	{
+		return itu_lib_collide_circle_circle(
+			shape_transform_point(&shape_0->transform, shape_0->circle.center), shape_0->circle.radius,
+			shape_transform_point(&shape_1->transform, shape_1->circle.center), shape_1->circle.radius,
+			out_contact
+		);
+	}
+
+	vec2f simplex[3];
+	int   simplex_count;
+	if(!itu_lib_overlaps_gjk(shape_0, shape_1, cache, simplex, &simplex_count))
+		return false;
+
+	return itu_lib_collide_epa(shape_0, shape_1, simplex, simplex_count, out_contact);
+}
+
+// *******************************************************************
+// time of impact
+// NOTE: all moving pairs are reduced to a segment (the relative motion of the first shape's center) against the second shape
+//       grown by the first one (ie, circle vs circle becomes segment vs circle with the sum of the radii)
+// *******************************************************************
+
+static inline void sweep_fill(float toi, vec2f normal, float* out_toi, vec2f* out_normal)
+{
+	*out_toi = toi;
+	if(out_normal)
+		*out_normal = normal;
+}
+
+bool itu_lib_sweep_segment_circle(vec2f segment_a, vec2f segment_b, vec2f circle_center, float circle_radius, float* out_toi, vec2f* out_normal)
+{
+	SDL_assert(out_toi);
+
+	vec2f d = segment_b - segment_a;
+	vec2f f = segment_a - circle_center;
+
+	// same quadratic as `itu_lib_overlaps_segment_circle()`, with the factors of 2 simplified away
+	float a = dot(d, d);
+	float b = dot(f, d);
+	float c = dot(f, f) - circle_radius*circle_radius;
+
+	if(c < 0)
+	{
+		// already overlapping
+		vec2f normal = normalize(-f);
+		if(length_sq(normal) == 0)
+			normal = a > 0 ? normalize(d) : VEC2F_UP;
+		sweep_fill(0, normal, out_toi, out_normal);
+		return true;
+	}
+
+	// NOTE: not moving (and not overlapping), or moving away from the circle
+	if(a == 0 || b >= 0)
+		return false;
+
+	float discriminant = b*b - a*c;
+	if(discriminant <= 0)
+		return false;
+
+	float t = (-b - SDL_sqrtf(discriminant)) / a;
+	if(t > 1)
+		return false;
+
+	t = SDL_max(t, 0.0f);
+	sweep_fill(t, normalize(circle_center - (segment_a + d * t)), out_toi, out_normal);
+	return true;
+}
+
+// slab test (see https://en.wikipedia.org/wiki/Slab_method)
+bool itu_lib_sweep_segment_rect(vec2f segment_a, vec2f segment_b, vec2f rect_min, vec2f rect_max, float* out_toi, vec2f* out_normal)
+{
+	SDL_assert(out_toi);
+
+	vec2f d = segment_b - segment_a;
+	float t_enter = 0;
+	float t_exit  = 1;
+	vec2f normal  = VEC2F_ZERO;
+
+	float d_axis[2]   = { d.x, d.y };
+	float a_axis[2]   = { segment_a.x, segment_a.y };
+	float min_axis[2] = { rect_min.x, rect_min.y };
+	float max_axis[2] = { rect_max.x, rect_max.y };
+	for(int axis = 0; axis < 2; ++axis)
+	{
+		if(d_axis[axis] == 0)
+		{
+			// NOTE: parallel to this slab, so it must already be inside it (strictly, like all other tests)
+			if(a_axis[axis] <= min_axis[axis] || a_axis[axis] >= max_axis[axis])
+				return false;
+			continue;
+		}
+
+		float inv = 1.0f / d_axis[axis];
+		float t_0 = (min_axis[axis] - a_axis[axis]) * inv;
+		float t_1 = (max_axis[axis] - a_axis[axis]) * inv;
+
+		// entering from the min side means moving towards +axis
+		float sign = 1;
+		if(t_0 > t_1)
+		{
+			float tmp = t_0; t_0 = t_1; t_1 = tmp;
+			sign = -1;
+		}
+
+		if(t_0 > t_enter)
+		{
+			t_enter = t_0;
+			normal = axis == 0 ? vec2f{ sign, 0 } : vec2f{ 0, sign };
+		}
+		t_exit = SDL_min(t_exit, t_1);
+
+		if(t_enter >= t_exit)
+			return false;
+	}
+
+	if(length_sq(normal) == 0)
+	{
+		// NOTE: segment starts inside the rect, use the closest side to get a sensible normal
+		float dist[4] = { segment_a.x - rect_min.x, rect_max.x - segment_a.x, segment_a.y - rect_min.y, rect_max.y - segment_a.y };
+		vec2f dirs[4] = { VEC2F_RIGHT, VEC2F_LEFT, VEC2F_UP, VEC2F_DOWN };
+		int   closest = 0;
+		for(int i = 1; i < 4; ++i)
+			if(dist[i] < dist[closest])
+				closest = i;
+		normal = dirs[closest];
+	}
+
+	sweep_fill(t_enter, normal, out_toi, out_normal);
+	return true;
+}
+
+bool itu_lib_sweep_circle_circle(vec2f circle_center_0, float circle_radius_0, vec2f circle_displacement_0, vec2f circle_center_1, float circle_radius_1, vec2f circle_displacement_1, float* out_toi, vec2f* out_normal)
+{
+	vec2f relative_displacement = circle_displacement_0 - circle_displacement_1;
+	return itu_lib_sweep_segment_circle(circle_center_0, circle_center_0 + relative_displacement, circle_center_1, circle_radius_0 + circle_radius_1, out_toi, out_normal);
+}
+
+// NOTE: the rect grown by the circle is a rounded rect. We test against the rect grown by the radius first (cheap),
+//       and only if we hit one of its corners we check the corner circle too
+bool itu_lib_sweep_circle_rect(vec2f circle_center, float circle_radius, vec2f circle_displacement, vec2f rect_min, vec2f rect_max, vec2f rect_displacement, float* out_toi, vec2f* out_normal)
+{
+	SDL_assert(out_toi);
+
+	vec2f segment_a = circle_center;
+	vec2f segment_b = circle_center + circle_displacement - rect_displacement;
+	vec2f grow      = vec2f{ circle_radius, circle_radius };
+
+	float toi;
+	vec2f normal;
+	if(!itu_lib_sweep_segment_rect(segment_a, segment_b, rect_min - grow, rect_max + grow, &toi, &normal))
+		return false;
+
+	vec2f p = segment_a + (segment_b - segment_a) * toi;
+	bool corner_x = p.x < rect_min.x || p.x > rect_max.x;
+	bool corner_y = p.y < rect_min.y || p.y > rect_max.y;
+	if(corner_x && corner_y)
+	{
+		vec2f corner = vec2f{ p.x < rect_min.x ? rect_min.x : rect_max.x, p.y < rect_min.y ? rect_min.y : rect_max.y };
+		return itu_lib_sweep_segment_circle(segment_a, segment_b, corner, circle_radius, out_toi, out_normal);
+	}
+
+	sweep_fill(toi, normal, out_toi, out_normal);
+	return true;
+}
+
+bool itu_lib_sweep_rect_rect(vec2f rect_min_0, vec2f rect_max_0, vec2f rect_displacement_0, vec2f rect_min_1, vec2f rect_max_1, vec2f rect_displacement_1, float* out_toi, vec2f* out_normal)
+{
+	vec2f half_extents = (rect_max_0 - rect_min_0) * 0.5f;
+	vec2f center       = rect_min_0 + half_extents;
+	vec2f relative_displacement = rect_displacement_0 - rect_displacement_1;
+	return itu_lib_sweep_segment_rect(center, center + relative_displacement, rect_min_1 - half_extents, rect_max_1 + half_extents, out_toi, out_normal);
+}
+
+// time of impact between the segment p_0-p_1 and the segment q_0-q_1 (as a fraction of p_0-p_1), parallel segments never hit
+static bool sweep_segment_segment_toi(vec2f p_0, vec2f p_1, vec2f q_0, vec2f q_1, float* out_toi)
+{
+	vec2f d = p_1 - p_0;
+	vec2f e = q_1 - q_0;
+	float den = cross(d, e);
+	if(den == 0)
+		return false;
+
+	vec2f f = q_0 - p_0;
+	float t = cross(f, e) / den;
+	float u = cross(f, d) / den;
+	if(t < 0 || t > 1 || u < 0 || u > 1)
+		return false;
+
+	*out_toi = t;
+	return true;
+}
+
+// NOTE: the capsule is the union of its two end circles and the rect between them, so the first hit is the earliest of those
+static bool sweep_segment_capsule(vec2f segment_a, vec2f segment_b, vec2f capsule_a, vec2f capsule_b, float capsule_radius, float* out_toi, vec2f* out_normal)
+{
+	vec2f closest = collide_closest_point_segment(segment_a, capsule_a, capsule_b);
+	if(length_sq(segment_a - closest) < capsule_radius*capsule_radius)
+		return itu_lib_sweep_segment_circle(segment_a, segment_b, closest, capsule_radius, out_toi, out_normal);
+
+	float toi_best = 2;
+	vec2f normal_best = VEC2F_ZERO;
+
+	float toi;
+	vec2f normal;
+	if(itu_lib_sweep_segment_circle(segment_a, segment_b, capsule_a, capsule_radius, &toi, &normal) && toi < toi_best)
+	{
+		toi_best = toi;
+		normal_best = normal;
+	}
+	if(itu_lib_sweep_segment_circle(segment_a, segment_b, capsule_b, capsule_radius, &toi, &normal) && toi < toi_best)
+	{
+		toi_best = toi;
+		normal_best = normal;
+	}
+
+	vec2f side = normalize(vec2f{ capsule_a.y - capsule_b.y, capsule_b.x - capsule_a.x });
+	for(int i = 0; i < 2; ++i)
+	{
+		vec2f offset = side * capsule_radius;
+		if(sweep_segment_segment_toi(segment_a, segment_b, capsule_a + offset, capsule_b + offset, &toi) && toi < toi_best)
+		{
+			toi_best = toi;
+			normal_best = -side;
+		}
+		side = -side;
+	}
+
+	if(toi_best > 1)
+		return false;
+
+	sweep_fill(toi_best, normal_best, out_toi, out_normal);
+	return true;
+}
+
+// clips the segment against every edge of the polygon (Cyrus-Beck), the last edge to be entered is the one hit
+static bool sweep_segment_polygon(vec2f segment_a, vec2f segment_b, vec2f* polygon_vertices, int poligon_vertices_count, float* out_toi, vec2f* out_normal)
+{
+	vec2f d = segment_b - segment_a;
+	float t_enter = 0;
+	float t_exit  = 1;
+	vec2f normal  = VEC2F_ZERO;
+
+	// in case the segment starts inside, the closest edge gives the normal
+	float inside_distance_best = SDL_MAX_SINT32;
+	vec2f inside_normal = VEC2F_UP;
+
+	for(int i = 0; i < poligon_vertices_count; ++i)
+	{
+		vec2f v_0 = polygon_vertices[i];
+		vec2f v_1 = polygon_vertices[(i + 1) % poligon_vertices_count];
+		vec2f edge_normal = vec2f{ v_1.y - v_0.y, v_0.x - v_1.x }; // outward for CCW polygons, not normalized
+
+		float num = dot(edge_normal, v_0 - segment_a);
+		float den = dot(edge_normal, d);
+
+		if(num <= 0)
+		{
+			// start is outside this edge
+			if(den >= 0)
+				return false;
+		}
+		else
+		{
+			float inside_distance = num * num / length_sq(edge_normal);
+			if(inside_distance < inside_distance_best)
+			{
+				inside_distance_best = inside_distance;
+				inside_normal = -edge_normal;
+			}
+		}
+
+		if(den == 0)
+			continue;
+
+		float t = num / den;
+		if(den < 0)
+		{
+			if(t >= t_enter)
+			{
+				t_enter = t;
+				normal = -edge_normal;
+			}
+		}
+		else
+		{
+			t_exit = SDL_min(t_exit, t);
+		}
+
+		if(t_enter >= t_exit)
+			return false;
+	}
+
+	if(length_sq(normal) == 0)
+		normal = inside_normal;
+
+	sweep_fill(t_enter, normalize(normal), out_toi, out_normal);
+	return true;
+}
+
+// segment (ie, a ray) against any shape
+// NOTE: instead of transforming the shape, we move the segment in the shape's local space (and the normal back to world space)
+bool itu_lib_sweep_segment_shape(vec2f segment_a, vec2f segment_b, Shape* shape, float* out_toi, vec2f* out_normal)
+{
+	SDL_assert(shape);
+	SDL_assert(out_toi);
+
+	ShapeTransform* transform = &shape->transform;
+	vec2f a = segment_a - transform->position;
+	vec2f b = segment_b - transform->position;
+	a = vec2f{ a.x * transform->rotation_cos + a.y * transform->rotation_sin, a.y * transform->rotation_cos - a.x * transform->rotation_sin };
+	b = vec2f{ b.x * transform->rotation_cos + b.y * transform->rotation_sin, b.y * transform->rotation_cos - b.x * transform->rotation_sin };
+
+	vec2f normal;
+	bool ret = false;
+	switch(shape->type)
+	{
+		case SHAPE_TYPE_CIRCLE:  ret = itu_lib_sweep_segment_circle(a, b, shape->circle.center, shape->circle.radius, out_toi, &normal); break;
+		case SHAPE_TYPE_RECT:    ret = itu_lib_sweep_segment_rect(a, b, shape->rect.min, shape->rect.max, out_toi, &normal); break;
+		case SHAPE_TYPE_CAPSULE: ret = sweep_segment_capsule(a, b, shape->capsule.a, shape->capsule.b, shape->capsule.radius, out_toi, &normal); break;
+		case SHAPE_TYPE_POLYGON: ret = sweep_segment_polygon(a, b, shape->polygon.vertices, shape->polygon.vertices_count, out_toi, &normal); break;
+		default: SDL_assert(false); break;
+	}
+
+	if(ret && out_normal)
+		*out_normal = vec2f{ normal.x * transform->rotation_cos - normal.y * transform->rotation_sin, normal.x * transform->rotation_sin + normal.y * transform->rotation_cos };
 	return ret;
 }
 
@@ -0,0 +1,333 @@
+// itu_lib_pairs.hpp
+// hash table of pairs of ids (ie, two entities) with some user data attached to each pair, that survives across frames
+//
+// usage:
+// - every frame, call `itu_lib_pairs_get()` for each pair you care about (ie, every pair reported by the broadphase)
+// - at the end of the frame, call `itu_lib_pairs_end_frame()`: pairs that were not touched during the frame get removed
+// - after that, `began`, `stayed` and `ended` list what happened to the pairs during the frame (until the next `itu_lib_pairs_get()`),
+//   so code that only cares about pairs starting or stopping doesn't need to look at all of them
+// - pairs that are not tested anymore but should not end (ie, between sleeping objects) can be kept alive with
+//   `itu_lib_pairs_keep()`, before `itu_lib_pairs_end_frame()`
+//
+// important notes:
+// - pairs are unordered: (a, b) and (b, a) are the same pair
+// - the user data of new pairs is zeroed, so "all zeroes" should be a sensible default
+// - open addressing with linear probing. Removing uses backward shift deletion, so there are no tombstones to clean up
+// - the table grows when it gets half full, so pointers returned by `itu_lib_pairs_get()` are only valid until the next call
+// - a pair touched more than once in the same frame shows up only once in the events
+// - ended pairs are already gone from the table, a copy of their user data is kept alongside the event
+// - `itu_lib_pairs_clear()` drops all pairs without reporting them as ended
+//
+// SDL functions used here:
+// - SDL_calloc(), SDL_realloc(), SDL_free()
+// - SDL_memcpy(), SDL_memset()
+
+#ifndef ITU_LIB_PAIRS_HPP
+#define ITU_LIB_PAIRS_HPP
+
+#include <itu_common.hpp>
+
+#define ITU_LIB_PAIRS_EMPTY SDL_MAX_UINT64
+
+typedef bool (*PairFilter)(void* userdata, Uint32 id_0, Uint32 id_1);
+
+struct PairEvent
+{
+	Uint32 id_0; // always the smaller one
+	Uint32 id_1;
+};
+
+struct PairEventList
+{
+	PairEvent* events;
+	Uint8*     data;     // `data_size` bytes per event, only used by `PairTable::ended`
+	int        count;
+	int        capacity;
+};
+
+struct PairTable
+{
+	Uint64* keys;      // (min_id << 32) | max_id, `ITU_LIB_PAIRS_EMPTY` for empty slots
+	Uint32* frames;    // frame in which each pair was last touched
+	Uint8*  data;      // `data_size` bytes per slot
+	int     data_size;
+	int     capacity;  // always a power of two
+	int     count;
+	Uint32  frame;
+
+	// events of the last frame
+	PairEventList began;  // pairs touched for the first time
+	PairEventList stayed; // pairs that were already there
+	PairEventList ended;  // pairs removed by `itu_lib_pairs_end_frame()`
+	Uint32        events_frame;
+};
+
+void  itu_lib_pairs_init(PairTable* table, int data_size, int capacity);
+void  itu_lib_pairs_deinit(PairTable* table);
+void  itu_lib_pairs_clear(PairTable* table);
+void* itu_lib_pairs_get(PairTable* table, Uint32 id_0, Uint32 id_1, bool* out_is_new);
+void* itu_lib_pairs_find(PairTable* table, Uint32 id_0, Uint32 id_1);
+int   itu_lib_pairs_keep(PairTable* table, PairFilter filter, void* userdata);
+int   itu_lib_pairs_end_frame(PairTable* table);
+
+#if defined ITU_LIB_PAIRS_IMPLEMENTATION || defined ITU_UNITY_BUILD
+
+static inline Uint64 pairs_make_key(Uint32 id_0, Uint32 id_1)
+{
+	SDL_assert(id_0 != id_1);
+
+	Uint32 id_min = SDL_min(id_0, id_1);
+	Uint32 id_max = SDL_max(id_0, id_1);
+	return ((Uint64)id_min << 32) | id_max;
+}
+
+// 64-bit finalizer from MurmurHash3, mixes all bits of the key into the low ones (which are the ones we use)
+static inline Uint32 pairs_hash(Uint64 key)
+{
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdull;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ull;
+	key ^= key >> 33;
+	return (Uint32)key;
+}
+
+static void pairs_alloc(PairTable* table, int capacity)
+{
+	table->capacity = capacity;
+	table->keys   = (Uint64*)SDL_calloc(capacity, sizeof(Uint64));
+	table->frames = (Uint32*)SDL_calloc(capacity, sizeof(Uint32));
+	table->data   = (Uint8*) SDL_calloc(capacity, table->data_size);
+	SDL_assert(table->keys && table->frames && table->data);
+
+	SDL_memset(table->keys, 0xFF, capacity * sizeof(Uint64));
+}
+
+static void pairs_event_push(PairEventList* list, Uint64 key, Uint8* data, int data_size)
+{
+	if(list->count == list->capacity)
+	{
+		list->capacity = SDL_max(list->capacity * 2, 64);
+		list->events = (PairEvent*)SDL_realloc(list->events, list->capacity * sizeof(PairEvent));
+		SDL_assert(list->events);
+		if(data)
+		{
+			list->data = (Uint8*)SDL_realloc(list->data, list->capacity * data_size);
+			SDL_assert(list->data);
+		}
+	}
+
+	list->events[list->count] = PairEvent{ (Uint32)(key >> 32), (Uint32)key };
+	if(data)
+		SDL_memcpy(list->data + list->count * data_size, data, data_size);
+	list->count++;
+}
+
+static void pairs_event_list_free(PairEventList* list)
+{
+	SDL_free(list->events);
+	SDL_free(list->data);
+	*list = PairEventList{ };
+}
+
+// events are kept until the table is used in the next frame
+static inline void pairs_events_reset(PairTable* table)
+{
+	if(table->events_frame == table->frame)
+		return;
+
+	table->began.count  = 0;
+	table->stayed.count = 0;
+	table->ended.count  = 0;
+	table->events_frame = table->frame;
+}
+
+// finds the slot of `key`, or the empty slot where it should go
+static inline int pairs_find_slot(PairTable* table, Uint64 key)
+{
+	Uint32 mask = table->capacity - 1;
+	Uint32 slot = pairs_hash(key) & mask;
+	while(table->keys[slot] != key && table->keys[slot] != ITU_LIB_PAIRS_EMPTY)
+		slot = (slot + 1) & mask;
+	return slot;
+}
+
+static void pairs_grow(PairTable* table)
+{
+	Uint64* keys_old   = table->keys;
+	Uint32* frames_old = table->frames;
+	Uint8*  data_old   = table->data;
+	int capacity_old   = table->capacity;
+
+	pairs_alloc(table, capacity_old * 2);
+	for(int i = 0; i < capacity_old; ++i)
+	{
+		if(keys_old[i] == ITU_LIB_PAIRS_EMPTY)
+			continue;
+
+		int slot = pairs_find_slot(table, keys_old[i]);
+		table->keys[slot]   = keys_old[i];
+		table->frames[slot] = frames_old[i];
+		SDL_memcpy(table->data + slot * table->data_size, data_old + i * table->data_size, table->data_size);
+	}
+
+	SDL_free(keys_old);
+	SDL_free(frames_old);
+	SDL_free(data_old);
+}
+
+// removes the pair in `slot`, moving back the following pairs of the same cluster so lookups don't stop too early
+static void pairs_remove_slot(PairTable* table, int slot)
+{
+	Uint32 mask = table->capacity - 1;
+	Uint32 hole = slot;
+	Uint32 next = (hole + 1) & mask;
+	while(table->keys[next] != ITU_LIB_PAIRS_EMPTY)
+	{
+		// a pair can fill the hole only if its ideal slot is not in (hole, next]
+		Uint32 ideal = pairs_hash(table->keys[next]) & mask;
+		if(((next - ideal) & mask) >= ((next - hole) & mask))
+		{
+			table->keys[hole]   = table->keys[next];
+			table->frames[hole] = table->frames[next];
+			SDL_memcpy(table->data + hole * table->data_size, table->data + next * table->data_size, table->data_size);
+			hole = next;
+		}
+		next = (next + 1) & mask;
+	}
+
+	table->keys[hole] = ITU_LIB_PAIRS_EMPTY;
+	table->count--;
+}
+
+// `capacity` is rounded up to a power of two
+void itu_lib_pairs_init(PairTable* table, int data_size, int capacity)
+{
+	SDL_assert(table);
+	SDL_assert(data_size > 0);
+
+	int capacity_pow2 = 16;
+	while(capacity_pow2 < capacity)
+		capacity_pow2 *= 2;
+
+	*table = PairTable{ };
+	table->data_size = data_size;
+	pairs_alloc(table, capacity_pow2);
+}
+
+void itu_lib_pairs_deinit(PairTable* table)
+{
+	SDL_free(table->keys);
+	SDL_free(table->frames);
+	SDL_free(table->data);
+	pairs_event_list_free(&table->began);
+	pairs_event_list_free(&table->stayed);
+	pairs_event_list_free(&table->ended);
+	*table = PairTable{ };
+}
+
+void itu_lib_pairs_clear(PairTable* table)
+{
+	SDL_memset(table->keys, 0xFF, table->capacity * sizeof(Uint64));
+	table->count = 0;
+
+	table->began.count  = 0;
+	table->stayed.count = 0;
+	table->ended.count  = 0;
+}
+
+// returns the user data of the pair, adding it (zeroed) if it's not there yet. The pair is marked as touched in the current frame
+void* itu_lib_pairs_get(PairTable* table, Uint32 id_0, Uint32 id_1, bool* out_is_new)
+{
+	SDL_assert(table);
+
+	// NOTE: keeping the load factor under 1/2 keeps probe sequences short
+	if((table->count + 1) * 2 > table->capacity)
+		pairs_grow(table);
+
+	pairs_events_reset(table);
+
+	Uint64 key = pairs_make_key(id_0, id_1);
+	int slot = pairs_find_slot(table, key);
+	bool is_new = table->keys[slot] == ITU_LIB_PAIRS_EMPTY;
+	if(is_new)
+	{
+		table->keys[slot] = key;
+		SDL_memset(table->data + slot * table->data_size, 0, table->data_size);
+		table->count++;
+		pairs_event_push(&table->began, key, NULL, 0);
+	}
+	else if(table->frames[slot] != table->frame)
+	{
+		pairs_event_push(&table->stayed, key, NULL, 0);
+	}
+	table->frames[slot] = table->frame;
+
+	if(out_is_new)
+		*out_is_new = is_new;
+	return table->data + slot * table->data_size;
+}
+
+// returns the user data of the pair, or NULL if it's not there. Doesn't mark the pair as touched
+void* itu_lib_pairs_find(PairTable* table, Uint32 id_0, Uint32 id_1)
+{
+	SDL_assert(table);
+
+	int slot = pairs_find_slot(table, pairs_make_key(id_0, id_1));
+	if(table->keys[slot] == ITU_LIB_PAIRS_EMPTY)
+		return NULL;
+	return table->data + slot * table->data_size;
+}
+
+// marks as touched every pair not touched yet in this frame for which `filter` returns true (they are listed in `stayed`)
+// returns the number of pairs kept
+// NOTE: like `itu_lib_pairs_end_frame()`, this goes through the whole table
+int itu_lib_pairs_keep(PairTable* table, PairFilter filter, void* userdata)
+{
+	SDL_assert(table && filter);
+
+	pairs_events_reset(table);
+
+	int kept_count = 0;
+	for(int i = 0; i < table->capacity; ++i)
+	{
+		Uint64 key = table->keys[i];
+		if(key == ITU_LIB_PAIRS_EMPTY || table->frames[i] == table->frame)
+			continue;
+		if(!filter(userdata, (Uint32)(key >> 32), (Uint32)key))
+			continue;
+
+		table->frames[i] = table->frame;
+		pairs_event_push(&table->stayed, key, NULL, 0);
+		kept_count++;
+	}
+	return kept_count;
+}
+
+// removes all pairs that were not touched during this frame (listing them in `ended`), and starts a new one
+// returns the number of pairs removed
+int itu_lib_pairs_end_frame(PairTable* table)
+{
+	SDL_assert(table);
+
+	pairs_events_reset(table);
+
+	int removed_count = 0;
+	for(int i = 0; i < table->capacity; ++i)
+	{
+		// NOTE: removing shifts the following pairs back, so the same slot needs to be checked again
+		while(table->keys[i] != ITU_LIB_PAIRS_EMPTY && table->frames[i] != table->frame)
+		{
+			pairs_event_push(&table->ended, table->keys[i], table->data + i * table->data_size, table->data_size);
+			pairs_remove_slot(table, i);
+			removed_count++;
+		}
+	}
+
+	table->frame++;
+	return removed_count;
+}
+
+#endif // ITU_LIB_PAIRS_IMPLEMENTATION
+
+#endif // ITU_LIB_PAIRS_HPP